@@ -36,20 +36,32 @@ RapidAcceptance::DetectorType RapidAcceptance::detectorFromString(TString str) {
 }
 
 bool RapidAcceptance::isSelected() {
+	++nTested_;
 	if(!inAcceptance()) {
 		return false;
 	}
+	++nInAcceptance_;
 
-	std::vector<RapidCut*>::iterator it = cuts_.begin();
-	for( ; it!= cuts_.end(); ++it) {
-		if(!(*it)->passCut()) {
+	for(unsigned int i=0; i<cuts_.size(); ++i) {
+		if(!cuts_[i]->passCut()) {
 			return false;
 		}
+		++nPassCuts_[i];
 	}
 
 	return true;
 }
 
+TString RapidAcceptance::cutName(unsigned int i) {
+	return cuts_[i]->name();
+}
+
+void RapidAcceptance::setCounts(Long64_t nTested, Long64_t nInAcceptance, const std::vector<Long64_t>& nPassCuts) {
+	nTested_ = nTested;
+	nInAcceptance_ = nInAcceptance;
+	nPassCuts_ = nPassCuts;
+}
+
 void RapidAcceptance::getDefaultPtRange(double& min, double& max) {
 	std::cout << "INFO in RapidAcceptance::getDefaultPtRange : Getting pT range for 4pi geometry." << std::endl;
 	std::cout << "                                             Range is 0 - 300 GeV." << std::endl;
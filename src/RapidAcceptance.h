@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "TLorentzVector.h"
+#include "TString.h"
 
 class RapidCut;
 class RapidParticle;
@@ -28,7 +29,8 @@ class RapidAcceptance {
 
 		RapidAcceptance(AcceptanceType type, const std::vector<RapidParticle*>& parts, const std::vector<RapidCut*>& cuts)
 			: type_(type),
-			  cuts_(cuts)
+			  cuts_(cuts),
+			  nTested_(0), nInAcceptance_(0), nPassCuts_(cuts.size(), 0)
 		{setup(parts);}
 
 		virtual ~RapidAcceptance() {}
@@ -38,6 +40,15 @@ class RapidAcceptance {
 		virtual void getDefaultPtRange(double& min, double& max);
 		virtual void getDefaultEtaRange(double& min, double& max);
 
+		//counts of events tested and passing each successive stage of the selection
+		Long64_t nTested() { return nTested_; }
+		Long64_t nInAcceptance() { return nInAcceptance_; }
+		Long64_t nPassCut(unsigned int i) { return nPassCuts_[i]; }
+		Long64_t nSelected() { return nPassCuts_.empty() ? nInAcceptance_ : nPassCuts_.back(); }
+		unsigned int nCuts() { return cuts_.size(); }
+		TString cutName(unsigned int i);
+		void setCounts(Long64_t nTested, Long64_t nInAcceptance, const std::vector<Long64_t>& nPassCuts);
+
 	private:
 		void setup(std::vector<RapidParticle*> parts);
 
@@ -57,6 +68,10 @@ class RapidAcceptance {
 		std::vector<RapidParticle*> parts_;
 
 		std::vector<RapidCut*> cuts_;
+
+		Long64_t nTested_;
+		Long64_t nInAcceptance_;
+		std::vector<Long64_t> nPassCuts_;
 };
 
 #endif
@@ -4,20 +4,14 @@
 #include <fstream>
 #include <iostream>
 
-RapidBeamData* RapidBeamData::instance_=0;
-
-RapidBeamData* RapidBeamData::getInstance() {
-	if(!instance_) {
-		instance_ = new RapidBeamData();
-		TString path;
-		path=getenv("RAPIDSIM_CONFIG");
-		if(path!="") instance_->loadData(path+"/config/beam.dat");
-		else {
-			path=getenv("RAPIDSIM_ROOT");
-			instance_->loadData(path+"/config/beam.dat");
-		}
+void RapidBeamData::loadDefaults() {
+	TString path;
+	path=getenv("RAPIDSIM_CONFIG");
+	if(path!="") loadData(path+"/config/beam.dat");
+	else {
+		path=getenv("RAPIDSIM_ROOT");
+		loadData(path+"/config/beam.dat");
 	}
-	return instance_;
 }
 
 
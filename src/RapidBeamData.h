@@ -11,23 +11,23 @@
 class RapidBeamData {
 	public:
 
-		static RapidBeamData* getInstance();
+		RapidBeamData()
+		: pileup_(0), sigmaxy_(0.), sigmaz_(0.) {}
+
+		~RapidBeamData() {}
 
+		//load beam.dat from RAPIDSIM_CONFIG or RAPIDSIM_ROOT
+		void loadDefaults();
 		void loadData(TString file);
 
 		int getPileup() { return pileup_; }
 		double getSigmaXY() { return sigmaxy_; }
 		double getSigmaZ() { return sigmaz_; }
 
+		void setPileup(int pileup) { pileup_ = pileup; }
 
-	private:
-
-		static RapidBeamData* instance_;
 
-		RapidBeamData()
-		: pileup_(0), sigmaxy_(0.), sigmaz_(0.) {}
-
-		~RapidBeamData() {}
+	private:
 
 		//copy constructor and copy assignment operator not implemented
 		RapidBeamData( const RapidBeamData& other );
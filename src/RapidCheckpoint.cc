@@ -0,0 +1,186 @@
+#include "RapidCheckpoint.h"
+
+#include <iostream>
+#include <vector>
+
+#include "TParameter.h"
+#include "TSystem.h"
+
+#include "RapidAcceptance.h"
+#include "RapidHistWriter.h"
+
+RapidCheckpoint::~RapidCheckpoint() {
+	if(file_) {
+		file_->Close();
+		delete file_;
+	}
+	if(rngInitial_) delete rngInitial_;
+}
+
+bool RapidCheckpoint::exists() {
+	//AccessPathName returns false if the file exists
+	return !gSystem->AccessPathName(fileName_);
+}
+
+bool RapidCheckpoint::load() {
+	std::cout << "INFO in RapidCheckpoint::load : loading checkpoint from file: " << fileName_ << std::endl;
+
+	file_ = TFile::Open(fileName_, "READ");
+	if(!file_ || file_->IsZombie()) {
+		std::cout << "ERROR in RapidCheckpoint::load : failed to open checkpoint file " << fileName_ << "." << std::endl;
+		return false;
+	}
+
+	if(!checkValue("nEvtToGen", nEvtToGen_)) return false;
+	if(!checkValue("nToReDecay", nToReDecay_)) return false;
+	if(!checkValue("nSelectedTarget", nSelectedTarget_)) return false;
+	if(!checkValue("saveTree", saveTree_)) return false;
+
+	TRandom* rng(0);
+	file_->GetObject("rngInitial", rng);
+	if(!rng) {
+		std::cout << "ERROR in RapidCheckpoint::load : checkpoint file does not contain the initial random number generator state." << std::endl;
+		return false;
+	}
+	rngInitial_ = rng;
+
+	return true;
+}
+
+void RapidCheckpoint::saveInitialState() {
+	//the decay setup may consume random numbers so the state before setup is needed to reproduce it
+	rngInitial_ = static_cast<TRandom*>(gRandom->Clone("rngInitial"));
+}
+
+void RapidCheckpoint::restoreInitialState() {
+	delete gRandom;
+	gRandom = static_cast<TRandom*>(rngInitial_->Clone());
+}
+
+bool RapidCheckpoint::restore(RapidHistWriter* writer, RapidAcceptance* acceptance, int& nEvent, int& nGenerated, int& nSelected) {
+	Long64_t value(0);
+
+	if(!readValue(file_, "nEvent", value)) return false;
+	nEvent = value;
+	if(!readValue(file_, "nGenerated", value)) return false;
+	nGenerated = value;
+	if(!readValue(file_, "nSelected", value)) return false;
+	nSelected = value;
+
+	//counts at each stage of the selection
+	Long64_t nTested(0), nInAcceptance(0);
+	std::vector<Long64_t> nPassCuts(acceptance->nCuts(), 0);
+	if(!readValue(file_, "nTested", nTested)) return false;
+	if(!readValue(file_, "nInAcceptance", nInAcceptance)) return false;
+	for(unsigned int i=0; i<nPassCuts.size(); ++i) {
+		TString name("nPassCut");
+		name += i;
+		if(!readValue(file_, name, nPassCuts[i])) return false;
+	}
+	acceptance->setCounts(nTested, nInAcceptance, nPassCuts);
+
+	TRandom* rng(0);
+	file_->GetObject("rng", rng);
+	if(!rng) {
+		std::cout << "ERROR in RapidCheckpoint::restore : checkpoint file does not contain the random number generator state." << std::endl;
+		return false;
+	}
+	delete gRandom;
+	gRandom = rng;
+
+	TDirectory* dir = file_->GetDirectory("writer");
+	if(!dir || !writer->restore(dir)) {
+		std::cout << "ERROR in RapidCheckpoint::restore : failed to restore output from checkpoint." << std::endl;
+		return false;
+	}
+
+	file_->Close();
+	delete file_;
+	file_ = 0;
+
+	std::cout << "INFO in RapidCheckpoint::restore : resuming from event " << nEvent << "." << std::endl
+		  << "                                    " << nGenerated << " generated and " << nSelected << " selected so far." << std::endl;
+
+	return true;
+}
+
+bool RapidCheckpoint::due() {
+	return interval_>0. && difftime(time(0), last_) >= interval_;
+}
+
+bool RapidCheckpoint::timeUp() {
+	return timeLimit_>0. && difftime(time(0), start_) >= timeLimit_;
+}
+
+bool RapidCheckpoint::write(RapidHistWriter* writer, RapidAcceptance* acceptance, int nEvent, int nGenerated, int nSelected) {
+	//write to a temporary file and move it into place so that an interrupted write leaves the last checkpoint intact
+	TString tmpName = fileName_+".tmp";
+	TFile* file = new TFile(tmpName, "RECREATE");
+	if(file->IsZombie()) {
+		std::cout << "ERROR in RapidCheckpoint::write : failed to open checkpoint file " << tmpName << "." << std::endl;
+		delete file;
+		return false;
+	}
+
+	//the output is flushed first so the tree on disk is never behind the checkpoint
+	TDirectory* dir = file->mkdir("writer");
+	writer->writeCheckpoint(dir);
+
+	writeValue(file, "nEvtToGen", nEvtToGen_);
+	writeValue(file, "nToReDecay", nToReDecay_);
+	writeValue(file, "nSelectedTarget", nSelectedTarget_);
+	writeValue(file, "saveTree", saveTree_);
+	writeValue(file, "nEvent", nEvent);
+	writeValue(file, "nGenerated", nGenerated);
+	writeValue(file, "nSelected", nSelected);
+	writeValue(file, "nTested", acceptance->nTested());
+	writeValue(file, "nInAcceptance", acceptance->nInAcceptance());
+	for(unsigned int i=0; i<acceptance->nCuts(); ++i) {
+		TString name("nPassCut");
+		name += i;
+		writeValue(file, name, acceptance->nPassCut(i));
+	}
+	file->WriteTObject(rngInitial_, "rngInitial");
+	file->WriteTObject(gRandom, "rng");
+
+	file->Close();
+	delete file;
+
+	if(gSystem->Rename(tmpName, fileName_)!=0) {
+		std::cout << "ERROR in RapidCheckpoint::write : failed to move checkpoint to " << fileName_ << "." << std::endl;
+		return false;
+	}
+
+	std::cout << "INFO in RapidCheckpoint::write : checkpoint written at event " << nEvent << "." << std::endl;
+	last_ = time(0);
+
+	return true;
+}
+
+void RapidCheckpoint::writeValue(TDirectory* dir, TString name, Long64_t value) {
+	TParameter<Long64_t> param(name, value);
+	dir->WriteTObject(&param);
+}
+
+bool RapidCheckpoint::readValue(TDirectory* dir, TString name, Long64_t& value) {
+	TParameter<Long64_t>* param(0);
+	dir->GetObject(name, param);
+	if(!param) {
+		std::cout << "ERROR in RapidCheckpoint::readValue : checkpoint does not contain the value " << name << "." << std::endl;
+		return false;
+	}
+	value = param->GetVal();
+	delete param;
+	return true;
+}
+
+bool RapidCheckpoint::checkValue(TString name, Long64_t expected) {
+	Long64_t value(0);
+	if(!readValue(file_, name, value)) return false;
+	if(value!=expected) {
+		std::cout << "ERROR in RapidCheckpoint::checkValue : checkpoint was written with " << name << "=" << value << " but this run uses " << expected << "." << std::endl
+			  << "                                        the same arguments must be used to resume a run." << std::endl;
+		return false;
+	}
+	return true;
+}
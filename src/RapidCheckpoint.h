@@ -0,0 +1,67 @@
+#ifndef RAPIDCHECKPOINT_H
+#define RAPIDCHECKPOINT_H
+
+#include <ctime>
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TRandom.h"
+#include "TString.h"
+
+class RapidAcceptance;
+class RapidHistWriter;
+
+class RapidCheckpoint {
+	public:
+		RapidCheckpoint(TString name, int nEvtToGen, int nToReDecay, int nSelectedTarget, bool saveTree)
+			: fileName_(name+"_checkpoint.root"), nEvtToGen_(nEvtToGen), nToReDecay_(nToReDecay), nSelectedTarget_(nSelectedTarget), saveTree_(saveTree),
+			  interval_(0.), timeLimit_(0.), start_(time(0)), last_(start_),
+			  rngInitial_(0), file_(0)
+			{}
+
+		~RapidCheckpoint();
+
+		void setInterval(double seconds) { interval_ = seconds; }
+		void setTimeLimit(double seconds) { timeLimit_ = seconds; }
+
+		bool exists();
+		bool load();
+
+		void saveInitialState();
+		void restoreInitialState();
+		bool restore(RapidHistWriter* writer, RapidAcceptance* acceptance, int& nEvent, int& nGenerated, int& nSelected);
+
+		bool due();
+		bool timeUp();
+		bool write(RapidHistWriter* writer, RapidAcceptance* acceptance, int nEvent, int nGenerated, int nSelected);
+
+		static void writeValue(TDirectory* dir, TString name, Long64_t value);
+		static bool readValue(TDirectory* dir, TString name, Long64_t& value);
+
+	private:
+		bool checkValue(TString name, Long64_t expected);
+
+		TString fileName_;
+
+		//run settings that must match when resuming
+		int nEvtToGen_;
+		int nToReDecay_;
+		int nSelectedTarget_;
+		bool saveTree_;
+
+		//seconds between checkpoints and before stopping
+		double interval_;
+		double timeLimit_;
+
+		//wall clock time at the start of the run and of the last checkpoint
+		time_t start_;
+		time_t last_;
+
+		//random number generator state before the decay is setup
+		TRandom* rngInitial_;
+
+		//checkpoint being resumed from
+		TFile* file_;
+};
+
+#endif
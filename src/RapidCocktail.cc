@@ -0,0 +1,256 @@
+#include "RapidCocktail.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+
+#include "TDirectory.h"
+#include "TNamed.h"
+#include "TRandom.h"
+#include "TSystem.h"
+
+#include "RapidAcceptance.h"
+#include "RapidConfig.h"
+#include "RapidDecay.h"
+#include "RapidHistWriter.h"
+#include "RapidParticle.h"
+#include "RapidResourceCache.h"
+
+RapidCocktail::~RapidCocktail() {
+	if(tree_) {
+		if(!treeSaved_) tree_->AutoSave();
+		treeFile_->Close();
+		delete treeFile_;
+	}
+	//the decay, acceptance and writer of each mode belong to its configuration
+	while(!configs_.empty()) {
+		delete configs_[configs_.size()-1];
+		configs_.pop_back();
+	}
+}
+
+bool RapidCocktail::load(TString fileName) {
+	fileName_ = fileName;
+
+	if(!loadModes()) return false;
+
+	//the modes share anything loaded from files and the generated lineshapes
+	RapidResourceCache::getInstance()->setEnabled(true);
+
+	//the random numbers are seeded once for the cocktail so that one mode does not replace the seed of another
+	int seed(0);
+	std::vector<TString> overrides;
+	for(unsigned int j=0; j<overrides_.size(); ++j) {
+		TString line = overrides_[j].Strip(TString::kBoth);
+		if(line.BeginsWith("seed") && line.Contains(":")) {
+			TString value = line(line.Index(":")+1, line.Length());
+			seed = value.Strip(TString::kBoth).Atoi();
+		} else {
+			overrides.push_back(overrides_[j]);
+		}
+	}
+	gRandom->SetSeed(seed);
+	std::cout << "INFO in RapidCocktail::load : seed for random number generation is " << gRandom->GetSeed() << "." << std::endl;
+
+	//the modes share one EvtGen instance, whose decay table holds a single decay of each particle
+	std::map<int, TString> evtGenDecays;
+	std::map<int, unsigned int> evtGenModes;
+
+	for(unsigned int i=0; i<modeNames_.size(); ++i) {
+		std::cout << "INFO in RapidCocktail::load : setting up mode " << i << " : " << modeNames_[i] << std::endl;
+
+		RapidConfig* config = new RapidConfig();
+		configs_.push_back(config);
+		config->setKeepSeed(true);
+		for(unsigned int j=0; j<overrides.size(); ++j) {
+			config->addOverride(overrides[j]);
+		}
+		if(!config->load(modeNames_[i])) {
+			std::cout << "ERROR in RapidCocktail::load : failed to load mode " << modeNames_[i] << "." << std::endl;
+			return false;
+		}
+
+		if(config->hasExternalGenerator()) {
+			const std::vector<RapidParticle*>& parts = config->getParticles();
+			for(unsigned int j=0; j<parts.size(); ++j) {
+				if(parts[j]->nDaughters()==0) continue;
+				TString rule = TString::Format("%d ->", parts[j]->id());
+				for(RapidParticle* daug=parts[j]->daughter(0); daug!=0; daug=daug->next()) {
+					rule += TString::Format(" %d", daug->id());
+				}
+				rule += " " + parts[j]->evtGenDecayModel();
+
+				int key = std::abs(parts[j]->id());
+				if(evtGenDecays.count(key) && evtGenDecays[key]!=rule) {
+					std::cout << "ERROR in RapidCocktail::load : modes " << modeNames_[evtGenModes[key]] << " and " << modeNames_[i] << " both decay " << parts[j]->name() << " with EvtGen." << std::endl
+						  << "                              EvtGen holds one decay of each particle so only one of these modes would be generated." << std::endl;
+					return false;
+				}
+				evtGenDecays[key] = rule;
+				evtGenModes[key] = i;
+			}
+		}
+
+		RapidDecay* decay = config->getDecay();
+		if(!decay) {
+			std::cout << "ERROR in RapidCocktail::load : failed to setup decay for mode " << modeNames_[i] << "." << std::endl;
+			return false;
+		}
+		decays_.push_back(decay);
+		acceptances_.push_back(config->getAcceptance());
+
+		//the events of all modes are written to the combined tree
+		writers_.push_back(config->getWriter(false));
+	}
+
+	//columns with the same name in several modes share a branch
+	for(unsigned int i=0; i<writers_.size(); ++i) {
+		std::vector<TString> names;
+		writers_[i]->getNames(names);
+		modeColumns_.push_back(std::vector<unsigned int>());
+		for(unsigned int j=0; j<names.size(); ++j) {
+			unsigned int column(0);
+			for( ; column<columns_.size(); ++column) {
+				if(columns_[column]==names[j]) break;
+			}
+			if(column==columns_.size()) columns_.push_back(names[j]);
+			modeColumns_[i].push_back(column);
+		}
+	}
+	values_.assign(columns_.size(), 0.);
+
+	return true;
+}
+
+bool RapidCocktail::loadModes() {
+	std::cout << "INFO in RapidCocktail::loadModes : loading modes from file: " << fileName_ << ".cocktail" << std::endl;
+
+	std::ifstream fin;
+	fin.open(fileName_+".cocktail", std::ifstream::in);
+	if(!fin.good()) {
+		std::cout << "ERROR in RapidCocktail::loadModes : file " << fileName_ << ".cocktail not found." << std::endl;
+		return false;
+	}
+
+	//modes are found relative to the cocktail file
+	TString dir = gSystem->DirName(fileName_);
+
+	TString line;
+	while(line.ReadLine(fin)) {
+		line = line.Strip(TString::kBoth);
+		if(line.IsNull() || line.BeginsWith("#")) continue;
+
+		TString mode, rate;
+		int from(0);
+		line.Tokenize(mode, from, "[ \t]+");
+		if(!line.Tokenize(rate, from, "[ \t]+") || !rate.IsFloat() || rate.Atof()<=0.) {
+			std::cout << "ERROR in RapidCocktail::loadModes : expected a mode and a positive rate but found: " << line << std::endl;
+			return false;
+		}
+
+		if(!mode.BeginsWith("/")) mode.Prepend(dir+"/");
+		modeNames_.push_back(mode);
+		rates_.push_back(rate.Atof());
+
+		totalRate_ += rate.Atof();
+		cumulativeRates_.push_back(totalRate_);
+	}
+	fin.close();
+
+	if(modeNames_.empty()) {
+		std::cout << "ERROR in RapidCocktail::loadModes : no modes found in " << fileName_ << ".cocktail." << std::endl;
+		return false;
+	}
+
+	for(unsigned int i=0; i<modeNames_.size(); ++i) {
+		std::cout << "INFO in RapidCocktail::loadModes : mode " << i << " is " << modeNames_[i] << " with fraction " << rates_[i]/totalRate_ << std::endl;
+	}
+
+	return true;
+}
+
+unsigned int RapidCocktail::chooseMode() {
+	double r = gRandom->Uniform(totalRate_);
+	for(unsigned int i=0; i<cumulativeRates_.size(); ++i) {
+		if(r<cumulativeRates_[i]) return i;
+	}
+	return cumulativeRates_.size()-1;
+}
+
+bool RapidCocktail::setupTree() {
+	//the combined tree only holds the default columns of each mode
+	for(unsigned int i=0; i<configs_.size(); ++i) {
+		if(configs_[i]->hasTreeOutputSettings()) {
+			std::cout << "ERROR in RapidCocktail::setupTree : mode " << modeNames_[i] << " uses tree settings, weights or smearing variations." << std::endl
+				  << "                                   these are not available for the combined tree of a cocktail." << std::endl;
+			return false;
+		}
+	}
+
+	TString treeFileName = outputName()+"_tree.root";
+	std::cout << "INFO in RapidCocktail::setupTree : tree will be saved to file: " << treeFileName << std::endl;
+
+	treeFile_ = new TFile(treeFileName, "RECREATE");
+	if(!treeFile_ || treeFile_->IsZombie()) {
+		std::cout << "ERROR in RapidCocktail::setupTree : failed to open " << treeFileName << "." << std::endl;
+		return false;
+	}
+
+	//the index stored in the tree of each mode
+	for(unsigned int i=0; i<modeNames_.size(); ++i) {
+		TNamed modeName(TString::Format("mode%d", i), modeNames_[i]);
+		treeFile_->WriteTObject(&modeName);
+	}
+
+	tree_ = new TTree("DecayTree","DecayTree");
+	tree_->SetDirectory(treeFile_);
+	tree_->Branch("nEvent", &nEvent_, "nEvent/I");
+	tree_->Branch("mode", &mode_, "mode/I");
+	for(unsigned int i=0; i<columns_.size(); ++i) {
+		tree_->Branch(columns_[i], &values_[i], columns_[i]+"/D");
+	}
+
+	return true;
+}
+
+void RapidCocktail::fill(unsigned int mode) {
+	RapidHistWriter* writer = writers_[mode];
+	writer->fill();
+	if(!tree_) return;
+
+	const std::vector<double>& values = writer->values();
+	const std::vector<unsigned int>& columns = modeColumns_[mode];
+
+	values_.assign(values_.size(), std::numeric_limits<double>::quiet_NaN());
+	for(unsigned int i=0; i<columns.size(); ++i) {
+		values_[columns[i]] = values[i];
+	}
+	mode_ = mode;
+	tree_->Fill();
+	treeSaved_ = false;
+}
+
+void RapidCocktail::save() {
+	TString histFileName = outputName()+"_hists.root";
+	std::cout << "INFO in RapidCocktail::save : saving histograms to file: " << histFileName << std::endl;
+
+	TFile* histFile = new TFile(histFileName, "RECREATE");
+	for(unsigned int i=0; i<writers_.size(); ++i) {
+		TDirectory* dir = histFile->mkdir(TString::Format("mode%d", i), modeNames_[i]);
+		writers_[i]->saveHistograms(dir);
+	}
+	histFile->Close();
+	delete histFile;
+
+	if(tree_) {
+		tree_->AutoSave();
+		treeSaved_ = true;
+	}
+}
+
+TString RapidCocktail::outputName() {
+	//strip away path for name of histogram/tuple files - save in PWD
+	return fileName_(fileName_.Last('/')+1, fileName_.Length());
+}
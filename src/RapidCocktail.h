@@ -0,0 +1,89 @@
+#ifndef RAPIDCOCKTAIL_H
+#define RAPIDCOCKTAIL_H
+
+#include <vector>
+
+#include "TFile.h"
+#include "TString.h"
+#include "TTree.h"
+
+class RapidAcceptance;
+class RapidConfig;
+class RapidDecay;
+class RapidHistWriter;
+
+//generates a mixture of decay modes in one job, choosing the mode of each parent according to its relative rate
+//
+//the modes are listed in <name>.cocktail, one per line, as the path to the mode (relative to the cocktail file) and its rate
+//the modes share the files and lineshapes held by RapidResourceCache, so each is only loaded once
+//the selected events of all modes are written to a single tree holding every column of any mode and the index of the mode
+//columns that a mode does not have are set to NaN - the histograms are written in a directory for each mode
+class RapidCocktail {
+	public:
+		RapidCocktail()
+			: treeFile_(0), tree_(0), treeSaved_(false), nEvent_(0), mode_(-1), totalRate_(0.)
+			{}
+
+		~RapidCocktail();
+
+		//a line in the format of the config file applied to every mode - must be given before loading
+		void addOverride(TString line) { overrides_.push_back(line); }
+
+		//load <fileName>.cocktail and set up each of its modes
+		bool load(TString fileName);
+
+		unsigned int nModes() { return configs_.size(); }
+		TString modeName(unsigned int mode) { return modeNames_[mode]; }
+		RapidDecay* getDecay(unsigned int mode) { return decays_[mode]; }
+		RapidAcceptance* getAcceptance(unsigned int mode) { return acceptances_[mode]; }
+		RapidHistWriter* getWriter(unsigned int mode) { return writers_[mode]; }
+
+		//choose the mode of the next parent
+		unsigned int chooseMode();
+
+		//set up the combined tree
+		bool setupTree();
+		void setNEvent(int nEvent) { nEvent_ = nEvent; }
+		//fill the histograms of a mode and the combined tree with its last selected event
+		void fill(unsigned int mode);
+		//write the combined tree and the histograms of each mode to <name>_hists.root
+		void save();
+
+		TString outputName();
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidCocktail( const RapidCocktail& other );
+		RapidCocktail& operator=( const RapidCocktail& other );
+
+		bool loadModes();
+
+		TString fileName_;
+
+		std::vector<TString> overrides_;
+
+		std::vector<TString> modeNames_;
+		std::vector<double> rates_;
+		std::vector<RapidConfig*> configs_;
+		std::vector<RapidDecay*> decays_;
+		std::vector<RapidAcceptance*> acceptances_;
+		std::vector<RapidHistWriter*> writers_;
+
+		//columns of the combined tree and where each column of each mode is found in them
+		std::vector<TString> columns_;
+		std::vector<std::vector<unsigned int> > modeColumns_;
+		std::vector<double> values_;
+
+		TFile* treeFile_;
+		TTree* tree_;
+		//whether the tree has been saved since it was last filled
+		bool treeSaved_;
+		int nEvent_;
+		int mode_;
+
+		//cumulative rates used to choose the mode of each parent
+		std::vector<double> cumulativeRates_;
+		double totalRate_;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <iostream>
 #include <queue>
+#include <sstream>
 
 #include "TFile.h"
 #include "TRandom.h"
@@ -11,11 +12,13 @@
 
 #include "RapidAcceptance.h"
 #include "RapidAcceptanceLHCb.h"
+#include "RapidBeamData.h"
 #include "RapidCut.h"
 #include "RapidDecay.h"
 #include "RapidExternalEvtGen.h"
 #include "RapidHistWriter.h"
 #include "RapidIPSmearGauss.h"
+#include "RapidMemory.h"
 #include "RapidMomentumSmearGauss.h"
 #include "RapidMomentumSmearEnergyGauss.h"
 #include "RapidMomentumSmearGaussPtEtaDep.h"
@@ -24,6 +27,11 @@
 #include "RapidParticle.h"
 #include "RapidParticleData.h"
 #include "RapidPID.h"
+#include "RapidProfiler.h"
+#include "RapidResourceCache.h"
+#include "RapidScan.h"
+#include "RapidSmearVariations.h"
+#include "RapidWeights.h"
 
 RapidConfig::~RapidConfig() {
 	std::map<TString, RapidMomentumSmear*>::iterator itr = momSmearCategories_.begin();
@@ -77,19 +85,56 @@ RapidConfig::~RapidConfig() {
 	}
 
 	if(accRejHisto_) delete accRejHisto_;
+	if(ptHisto_) delete ptHisto_;
+	if(etaHisto_) delete etaHisto_;
+	if(pvHisto_) delete pvHisto_;
 
 	if(acceptance_) delete acceptance_;
 	if(decay_) delete decay_;
 	if(writer_) delete writer_;
 	if(external_) delete external_;
+	if(scan_) delete scan_;
+	if(weights_) delete weights_;
+	if(smearVariations_) delete smearVariations_;
 }
 
 bool RapidConfig::load(TString fileName) {
 	fileName_ = fileName;
 
-	if(!loadDecay()) return false;
-	if(!loadConfig()) return false;
+	if(profiler_) profiler_->start(RapidProfiler::LOADDECAY);
+	bool loaded = loadDecay();
+	if(profiler_) profiler_->stop(RapidProfiler::LOADDECAY);
+	if(!loaded) return false;
 
+	if(profiler_) profiler_->start(RapidProfiler::LOADCONFIG);
+	loaded = loadConfig();
+	if(profiler_) profiler_->stop(RapidProfiler::LOADCONFIG);
+	if(!loaded) return false;
+
+	return completeLoad();
+}
+
+bool RapidConfig::load(TString name, TString decay, TString config) {
+	fileName_ = name;
+
+	std::cout << "INFO in RapidConfig::load : loading decay mode " << name << " from memory" << std::endl;
+
+	if(profiler_) profiler_->start(RapidProfiler::LOADDECAY);
+	std::istringstream decayIn(decay.Data());
+	bool loaded = loadDecay(decayIn);
+	if(profiler_) profiler_->stop(RapidProfiler::LOADDECAY);
+	if(!loaded) return false;
+
+	if(profiler_) profiler_->start(RapidProfiler::LOADCONFIG);
+	std::istringstream configIn(config.Data());
+	loaded = loadConfig(configIn);
+	if(profiler_) profiler_->stop(RapidProfiler::LOADCONFIG);
+	if(!loaded) return false;
+
+	return completeLoad();
+}
+
+bool RapidConfig::completeLoad() {
 	//automatically add the corrected mass variable if we have any invisible particles
 	for(unsigned int i=0; i<parts_.size(); ++i) {
 		if(parts_[i]->invisible()) {
@@ -121,7 +166,10 @@ RapidDecay* RapidConfig::getDecay() {
 		//check we have a particle to decay
 		if(parts_.empty()) return 0;
 
-		decay_ = new RapidDecay(parts_);
+		//the masses are setup when the decay is created
+		if(profiler_) profiler_->start(RapidProfiler::SETUPMASS);
+		decay_ = new RapidDecay(parts_, &particleData_, &beamData_);
+		if(profiler_) profiler_->stop(RapidProfiler::SETUPMASS);
 
 		//check decay
 		if(!decay_->checkDecay()) {
@@ -129,10 +177,22 @@ RapidDecay* RapidConfig::getDecay() {
 		}
 
 		//check that we have an FONLL model for the parent kinematics
-		if(!loadParentKinematics()) {
+		if(profiler_) profiler_->start(RapidProfiler::LOADPARENTKINEMATICS);
+		bool loaded = loadParentKinematics();
+		if(profiler_) profiler_->stop(RapidProfiler::LOADPARENTKINEMATICS);
+		if(!loaded) {
 			return 0;
 		}
 		decay_->setParentKinematics(ptHisto_,etaHisto_);
+		if(smearVariations_) {
+			smearVariations_->setDecay(decay_, parts_);
+			decay_->setSmearVariations(smearVariations_);
+		}
+
+		//the alternative settings are compared to the nominal shape before it is corrected for phase space
+		if(weights_ && !loadWeights()) {
+			return 0;
+		}
 
 		if(!loadPVntracks()) {
 			return 0;
@@ -144,12 +204,14 @@ RapidDecay* RapidConfig::getDecay() {
 
 		//load any PDF to generate
 		if(accRejHisto_ && accRejParameterX_) {
+			if(profiler_) profiler_->start(RapidProfiler::ACCREJDENOMINATOR);
 			if(accRejParameterY_) {
 				decay_->setAcceptRejectHist(accRejHisto_,accRejParameterX_,accRejParameterY_);
 			}
 			else {
 				decay_->setAcceptRejectHist(accRejHisto_,accRejParameterX_);
 			}
+			if(profiler_) profiler_->stop(RapidProfiler::ACCREJDENOMINATOR);
 		}
 		if(external_) {
 			decay_->setExternal(external_);
@@ -177,20 +239,74 @@ RapidHistWriter* RapidConfig::getWriter(bool saveTree) {
 	setupDefaultParams();
 
 	if(!writer_) {
-		//strip away path for name of histogram/tuple files - save in PWD
-		TString histFileName(fileName_( fileName_.Last('/')+1, fileName_.Length()));
-		if(!outputDir_.empty()) histFileName.Prepend((outputDir_+"/").data());
-		writer_ = new RapidHistWriter(parts_, params_, paramsStable_, paramsDecaying_, paramsTwoBody_, paramsThreeBody_, histFileName, saveTree);
+		writer_ = new RapidHistWriter(parts_, params_, paramsStable_, paramsDecaying_, paramsTwoBody_, paramsThreeBody_, outputName(), saveTree, treeSettings_, weights_, smearVariations_);
 	}
 
 	return writer_;
 }
 
+TString RapidConfig::outputName() {
+	//strip away path for name of histogram/tuple files - save in PWD
+	TString name(fileName_( fileName_.Last('/')+1, fileName_.Length()));
+	if(!outputDir_.empty()) name.Prepend((outputDir_+"/").data());
+	return name+outputSuffix_;
+}
+
+void RapidConfig::reseed(unsigned int seed) {
+	gRandom->SetSeed(seed);
+	if(external_) external_->setSeed(seed);
+}
+
+void RapidConfig::measureMemory(RapidMemory& memory) {
+	Long64_t massData(0);
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		massData += parts_[i]->massDataBytes();
+	}
+
+	Long64_t kinematics = RapidMemory::histBytes(ptHisto_) + RapidMemory::histBytes(etaHisto_)
+			    + RapidMemory::histBytes(pvHisto_) + RapidMemory::histBytes(accRejHisto_);
+
+	Long64_t pidHists(0), pidCache(0);
+	std::map<RapidParam::ParamType, RapidPID*>::iterator itr = pidHists_.begin();
+	for( ; itr!=pidHists_.end(); ++itr) {
+		pidHists += itr->second->histogramBytes();
+		pidCache += itr->second->cacheBytes();
+	}
+
+	memory.add("massDataSets", massData);
+	memory.add("kinematicHistograms", kinematics);
+	memory.add("pidHistograms", pidHists);
+	memory.add("pidCache", pidCache);
+	memory.add("writerHistograms", writer_ ? writer_->histogramBytes() : 0);
+	memory.add("treeBaskets", writer_ ? writer_->basketBytes() : 0);
+
+	//resources kept between jobs - lineshapes in use are also counted in massDataSets
+	RapidResourceCache* cache = RapidResourceCache::getInstance();
+	if(cache->enabled()) memory.add("resourceCache", cache->bytes());
+}
+
+RapidMomentumSmear* RapidConfig::getMomentumSmearing(TString category) {
+	if(!momSmearCategories_.count(category)) {
+		if(!loadSmearing(category) || !momSmearCategories_.count(category)) return 0;
+	}
+	return momSmearCategories_[category];
+}
+
+RapidIPSmear* RapidConfig::getIPSmearing(TString category) {
+	if(!ipSmearCategories_.count(category)) {
+		if(!loadSmearing(category) || !ipSmearCategories_.count(category)) return 0;
+	}
+	return ipSmearCategories_[category];
+}
+
+RapidPID* RapidConfig::getPID(RapidParam::ParamType type) {
+	std::map<RapidParam::ParamType, RapidPID*>::iterator itr = pidHists_.find(type);
+	if(itr==pidHists_.end()) return 0;
+	return itr->second;
+}
+
 bool RapidConfig::loadDecay() {
 	std::cout << "INFO in RapidConfig::loadDecay : loading decay descriptor from file: " << fileName_ << ".decay" << std::endl;
-	TString decayStr;
-	std::queue<TString> decays;
-	std::queue<RapidParticle*> mothers;
 
 	std::ifstream fin;
 	fin.open(fileName_+".decay");
@@ -198,16 +314,28 @@ bool RapidConfig::loadDecay() {
 		std::cout << "ERROR in RapidConfig::loadDecay : file " << fileName_ << ".decay not found." << std::endl;
 		return false;
 	}
-	decayStr.ReadLine(fin);
+	bool loaded = loadDecay(fin);
 	fin.close();
 
+	return loaded;
+}
+
+bool RapidConfig::loadDecay(std::istream& in) {
+	TString decayStr;
+	std::queue<TString> decays;
+	std::queue<RapidParticle*> mothers;
+
+	decayStr.ReadLine(in);
+
+	//the particles are made from the particle data of this configuration
+	particleData_.loadDefaults();
+	beamData_.loadDefaults();
+
 	std::cout << "INFO in RapidConfig::loadDecay : Decay descriptor is:" << std::endl
 		  << "                                 " << decayStr << std::endl;
 
 	decays.push(decayStr);
 
-	RapidParticleData* particleData = RapidParticleData::getInstance();
-
 	while(!decays.empty()) {
 
 		decayStr = decays.front();
@@ -255,7 +383,7 @@ bool RapidConfig::loadDecay() {
 		decayStr.Tokenize(token, from, " ");
 		//only need to add this if it is the top particle
 		if(parts_.empty()) {
-			theMother = particleData->makeParticle(token, 0);
+			theMother = particleData_.makeParticle(token, 0);
 			parts_.push_back(theMother);
 
 			//get flavour of mother for FONLL
@@ -282,7 +410,7 @@ bool RapidConfig::loadDecay() {
 				token = token.Strip(TString::kBoth,'^');
 				stable = false;//flags it to edit later
 			}
-			RapidParticle* part = particleData->makeParticle(token, theMother);
+			RapidParticle* part = particleData_.makeParticle(token, theMother);
 			if(!stable) mothers.push(part);
 			parts_.push_back(part);
 			theMother->addDaughter(part);
@@ -297,8 +425,6 @@ bool RapidConfig::loadDecay() {
 bool RapidConfig::loadConfig() {
 	std::cout << "INFO in RapidConfig::loadConfig : attempting to load configuration from file: " << fileName_+".config" << std::endl;
 
-	gRandom->SetSeed(0.);
-
 	std::ifstream fin;
 	fin.open(fileName_+".config", std::ifstream::in);
 	if( ! fin.good()) {
@@ -308,10 +434,19 @@ bool RapidConfig::loadConfig() {
 		fin.open(fileName_+".config", std::ifstream::in);
 	}
 
+	bool loaded = loadConfig(fin);
+	fin.close();
+
+	return loaded;
+}
+
+bool RapidConfig::loadConfig(std::istream& in) {
+	if(!keepSeed_) gRandom->SetSeed(0.);
+
 	TString buffer;
 	unsigned int currentPart(parts_.size());
-	while(fin.good()) {
-		buffer.ReadLine(fin);
+	while(in.good()) {
+		buffer.ReadLine(in);
 		switch(buffer[0]) {
 			case '@': //particle config
 				buffer.Remove(TString::kBoth,'@');
@@ -323,33 +458,45 @@ bool RapidConfig::loadConfig() {
 			case '#': //comment
 				continue;
 			default: //continue particle or global config
-				int colon = buffer.Index(":");
-				TString command = buffer(0,colon);
-				command = command.Strip(TString::kBoth);
-				TString value = buffer(colon+1, buffer.Length()-colon-1);
-				value = value.Strip(TString::kBoth);
-
-				if(currentPart==parts_.size()) {
-					if(!configGlobal(command, value)) {
-						fin.close();
-						return false;
-					}
-				}
-				else {
-					if(!configParticle(currentPart, command, value)) {
-						fin.close();
-						return false;
-					}
-				}
+				if(!configLine(currentPart, buffer)) return false;
 				break;
 		}
 	}
+
+	//settings given in addition to the file, e.g. by a job sent to a running service
+	for(unsigned int i=0; i<overrides_.size(); ++i) {
+		TString line = overrides_[i].Strip(TString::kBoth);
+		unsigned int part = parts_.size();
+		if(line.BeginsWith("@")) {
+			int space = line.First(' ');
+			if(space<0) space = line.First('\t');
+			TString index = line(1, space-1);
+			part = index.Atoi();
+			if(space<0 || !index.IsDigit() || part>=parts_.size()) {
+				std::cout << "ERROR in RapidConfig::loadConfig : invalid particle in setting " << line << std::endl;
+				return false;
+			}
+			line = line(space+1, line.Length()-space-1);
+		}
+		std::cout << "INFO in RapidConfig::loadConfig : applying setting " << overrides_[i] << std::endl;
+		if(!configLine(part, line)) return false;
+	}
 	std::cout << "INFO in RapidConfig::loadConfig : finished loading configuration." << std::endl;
-	fin.close();
 
 	return true;
 }
 
+bool RapidConfig::configLine(unsigned int part, TString line) {
+	int colon = line.Index(":");
+	TString command = line(0,colon);
+	command = command.Strip(TString::kBoth);
+	TString value = line(colon+1, line.Length()-colon-1);
+	value = value.Strip(TString::kBoth);
+
+	if(part==parts_.size()) return configGlobal(command, value);
+	else return configParticle(part, command, value);
+}
+
 void RapidConfig::writeConfig() {
 	std::ofstream fout;
 	fout.open(fileName_+".config", std::ofstream::out);
@@ -410,6 +557,12 @@ bool RapidConfig::configParticle(unsigned int part, TString command, TString val
 		parts_[part]->setName(value);
 	} else if(command=="smear") {
 		setSmearing(part, value);
+	} else if(command=="smearVariations") {
+		if(!setSmearVariations(part, value)) {
+			std::cout << "ERROR in RapidConfig::configParticle : failed to load smearing variations." << std::endl
+				  << "                                       fix your configuration file." << std::endl;
+			return false;
+		}
 	} else if(command=="invisible") {
 		if(value=="false") {
 			parts_[part]->setInvisible(false);
@@ -417,7 +570,7 @@ bool RapidConfig::configParticle(unsigned int part, TString command, TString val
 			parts_[part]->setInvisible(true);
 		}
 	} else if(command=="altMass") {
-		RapidParticleData* rpd = RapidParticleData::getInstance();
+		RapidParticleData* rpd = &particleData_;
 
 		int from(0);
 		TString buffer;
@@ -446,6 +599,11 @@ bool RapidConfig::configParticle(unsigned int part, TString command, TString val
 
 bool RapidConfig::configGlobal(TString command, TString value) {
 	if(command=="seed") {
+		if(keepSeed_) {
+			std::cout << "WARNING in RapidConfig::configGlobal : the random numbers have already been seeded." << std::endl
+				  << "                                      seed " << value << " will be ignored." << std::endl;
+			return true;
+		}
 		int seed = value.Atoi();
 		gRandom->SetSeed(seed);
 		std::cout << "INFO in RapidConfig::configGlobal : setting seed for random number generation to " << seed << "." << std::endl
@@ -477,8 +635,11 @@ bool RapidConfig::configGlobal(TString command, TString value) {
 		motherFlavour_ = value;
 		std::cout << "INFO in RapidConfig::configGlobal : parent flavour forced to be " << motherFlavour_ << "." << std::endl;
 	} else if(command=="minWidth") {
-		RapidParticleData::getInstance()->setNarrowWidth(value.Atof());
+		particleData_.setNarrowWidth(value.Atof());
 		std::cout << "INFO in RapidConfig::configGlobal : minimum resonance width to be generated set to " << value.Atof() << " GeV." << std::endl;
+	} else if(command=="pileup") {
+		beamData_.setPileup(value.Atoi());
+		std::cout << "INFO in RapidConfig::configGlobal : mean number of pileup vertices set to " << value.Atoi() << "." << std::endl;
 	} else if(command=="maxAttempts") {
 		maxgen_ = value.Atof();
 		std::cout << "INFO in RapidConfig::configGlobal : maximum number of attempts to generated an event set to " << maxgen_ << "." << std::endl;
@@ -518,6 +679,18 @@ bool RapidConfig::configGlobal(TString command, TString value) {
 			std::cout << "INFO in RapidConfig::configGlobal : adding cut " << cut->name() << std::endl;
 			cuts_.push_back(cut);
 		}
+	} else if(command=="scan") {
+		if(!loadScan(value)) {
+			std::cout << "ERROR in RapidConfig::configGlobal : failed to load scan." << std::endl
+				  << "                                     fix your configuration file." << std::endl;
+			return false;
+		}
+	} else if(command=="weight") {
+		if(!loadWeight(value)) {
+			std::cout << "ERROR in RapidConfig::configGlobal : failed to load weight." << std::endl
+				  << "                                     fix your configuration file." << std::endl;
+			return false;
+		}
 	} else if(command=="shape") {
 		int from(0);
 		TString histName, histFile;
@@ -566,9 +739,39 @@ bool RapidConfig::configGlobal(TString command, TString value) {
 		value.Tokenize(histFile,from," ");
 		histFile = histFile.Strip(TString::kBoth);
 
+		if(profiler_) profiler_->start(RapidProfiler::LOADPID);
 		pidLoaded_ = loadPID(histFile);
+		if(profiler_) profiler_->stop(RapidProfiler::LOADPID);
 		if(!pidLoaded_) return false;
 	}
+	else if (command=="treeCompression") {
+		std::cout << "INFO in RapidConfig::configGlobal : setting tree compression to " << value << "." << std::endl;
+		if(!treeSettings_.setCompression(value)) return false;
+	}
+	else if (command=="treeBasketSize") {
+		std::cout << "INFO in RapidConfig::configGlobal : setting tree basket size to " << value << " bytes." << std::endl;
+		if(!treeSettings_.setBasketSize(value)) return false;
+	}
+	else if (command=="treeAutoFlush") {
+		std::cout << "INFO in RapidConfig::configGlobal : setting tree auto-flush to " << value << "." << std::endl;
+		if(!treeSettings_.setAutoFlush(value)) return false;
+	}
+	else if (command=="treeThreads") {
+		std::cout << "INFO in RapidConfig::configGlobal : using " << value << " threads to compress the tree." << std::endl;
+		if(!treeSettings_.setThreads(value)) return false;
+	}
+	else if (command=="treeStorage") {
+		std::cout << "INFO in RapidConfig::configGlobal : adding tree storage rule " << value << "." << std::endl;
+		if(!treeSettings_.addStorage(value)) return false;
+	}
+	else if (command=="treeMaxSize") {
+		std::cout << "INFO in RapidConfig::configGlobal : output tree will roll over to a new file every " << value << " MB." << std::endl;
+		if(!treeSettings_.setMaxFileSize(value)) return false;
+	}
+	else if (command=="treeMaxEvents") {
+		std::cout << "INFO in RapidConfig::configGlobal : output tree will roll over to a new file every " << value << " events." << std::endl;
+		if(!treeSettings_.setMaxFileEntries(value)) return false;
+	}
 	else if (command=="outputDirectory") {
 		outputDir_ = gSystem->ExpandPathName(value.Data());
 		std::cout << "INFO in RapidConfig::configGlobal : setting output directory to " << outputDir_ << "." << std::endl;
@@ -693,6 +896,154 @@ RapidCut* RapidConfig::loadCut(TString cutStr) {
 
 }
 
+bool RapidConfig::loadScan(TString scanStr) {
+	int from(0);
+	TString paramName, scanType, buffer;
+
+	scanStr.Tokenize(paramName,from," ");
+	RapidParam* param = findParam(paramName);
+	if(!param) {
+		std::cout << "ERROR in RapidConfig::loadScan : failed to setup scan - unknown parameter." << std::endl;
+		return false;
+	}
+
+	if(!scanStr.Tokenize(scanType,from," ")) {
+		std::cout << "ERROR in RapidConfig::loadScan : failed to setup scan - no scan type given." << std::endl;
+		return false;
+	}
+
+	double values[3];
+	for(int i=0; i<3; ++i) {
+		if(!scanStr.Tokenize(buffer,from," ") || !buffer.IsFloat()) {
+			std::cout << "ERROR in RapidConfig::loadScan : failed to setup scan - expected the first and last thresholds and the number of steps." << std::endl;
+			return false;
+		}
+		values[i] = buffer.Atof();
+	}
+
+	if(!scan_) scan_ = new RapidScan();
+	if(!scan_->addVariable(param, scanType, values[0], values[1], static_cast<int>(values[2]))) return false;
+
+	std::cout << "INFO in RapidConfig::loadScan : scanning " << scan_->name(scan_->nVariables()-1) << " from " << values[0] << " to " << values[1] << " in " << static_cast<int>(values[2]) << " steps" << std::endl;
+	return true;
+}
+
+bool RapidConfig::loadWeight(TString weightStr) {
+	int from(0);
+	TString name, setting, buffer;
+
+	if(!weightStr.Tokenize(name,from," ") || !weightStr.Tokenize(setting,from," ")) {
+		std::cout << "ERROR in RapidConfig::loadWeight : failed to setup weight - expected a name and an alternative setting." << std::endl;
+		return false;
+	}
+
+	int nArgs(0);
+	while(weightStr.Tokenize(buffer,from," ")) ++nArgs;
+
+	if(setting=="energy") {
+		if(nArgs!=1) {
+			std::cout << "ERROR in RapidConfig::loadWeight : failed to setup weight - expected a single alternative energy." << std::endl;
+			return false;
+		}
+	} else if(setting=="kinematics") {
+		if(nArgs!=3) {
+			std::cout << "ERROR in RapidConfig::loadWeight : failed to setup weight - expected a file and the names of the pT and eta histograms." << std::endl;
+			return false;
+		}
+	} else if(setting=="shape") {
+		if(nArgs!=2) {
+			std::cout << "ERROR in RapidConfig::loadWeight : failed to setup weight - expected a file and the name of the histogram." << std::endl;
+			return false;
+		}
+	} else if(setting=="minWidth") {
+		//a resonance is either fixed at its mass or given a lineshape, so the two densities cannot be compared
+		std::cout << "ERROR in RapidConfig::loadWeight : failed to setup weight - minWidth changes which resonances are generated with a lineshape." << std::endl
+			  << "                                   events cannot be reweighted to an alternative minWidth." << std::endl;
+		return false;
+	} else {
+		std::cout << "ERROR in RapidConfig::loadWeight : failed to setup weight - unknown setting " << setting << "." << std::endl;
+		return false;
+	}
+
+	if(!weights_) weights_ = new RapidWeights();
+	if(!weights_->addVariation(name)) return false;
+	weightSettings_.push_back(weightStr);
+
+	std::cout << "INFO in RapidConfig::loadWeight : adding weight " << name << " for alternative " << setting << "." << std::endl;
+	return true;
+}
+
+bool RapidConfig::loadWeights() {
+	weights_->setNominalKinematics(parts_[0], ptHisto_, etaHisto_);
+	if(accRejHisto_ && accRejParameterX_) {
+		TH1* shape = dynamic_cast<TH1*>(accRejHisto_->Clone("nominalShape"));
+		shape->SetDirectory(0);
+		weights_->setNominalShape(shape, accRejParameterX_, accRejParameterY_);
+	}
+
+	for(unsigned int i=0; i<weightSettings_.size(); ++i) {
+		int from(0);
+		TString name, setting, fileName, histName, etaName;
+		weightSettings_[i].Tokenize(name,from," ");
+		weightSettings_[i].Tokenize(setting,from," ");
+
+		TFile* file(0);
+		if(setting=="energy") {
+			TString energy;
+			weightSettings_[i].Tokenize(energy,from," ");
+			file = openKinematicsFile(energy.Atof());
+			histName = "pT";
+			etaName = "eta";
+		} else {
+			weightSettings_[i].Tokenize(fileName,from," ");
+			weightSettings_[i].Tokenize(histName,from," ");
+			if(setting=="kinematics") weightSettings_[i].Tokenize(etaName,from," ");
+			file = RapidResourceCache::getInstance()->openFile(fileName);
+			if(!file) {
+				std::cout << "ERROR in RapidConfig::loadWeights : could not open file " << fileName << " for weight " << name << "." << std::endl
+					  << "                                    path should be absolute or relative to '" << getenv("PWD") << "'." << std::endl;
+			}
+		}
+		if(!file) return false;
+
+		TH1* hist = dynamic_cast<TH1*>(RapidResourceCache::getInstance()->getObject(file, histName));
+		if(!hist) {
+			std::cout << "ERROR in RapidConfig::loadWeights : could not load histogram " << histName << " for weight " << name << "." << std::endl;
+			return false;
+		}
+
+		if(setting=="shape") {
+			if(!weights_->setShape(i, hist)) {
+				delete hist;
+				return false;
+			}
+			continue;
+		}
+
+		TH1* etaHisto = dynamic_cast<TH1*>(RapidResourceCache::getInstance()->getObject(file, etaName));
+		if(!check1D(hist) || !etaHisto || !check1D(etaHisto)) {
+			std::cout << "ERROR in RapidConfig::loadWeights : pT and eta histograms of weight " << name << " must be TH1F or TH1D." << std::endl;
+			delete hist;
+			if(etaHisto) delete etaHisto;
+			return false;
+		}
+
+		//the alternative densities are normalised over the generated range
+		TH1* ptReduced = reduceHistogram(hist,ptMin_,ptMax_);
+		TH1* etaReduced = reduceHistogram(etaHisto,etaMin_,etaMax_);
+		if(ptReduced!=hist) delete hist;
+		if(etaReduced!=etaHisto) delete etaHisto;
+
+		if(!weights_->setKinematics(i, ptReduced, etaReduced)) {
+			delete ptReduced;
+			delete etaReduced;
+			return false;
+		}
+	}
+
+	return true;
+}
+
 RapidParam* RapidConfig::findParam(TString name) {
 	std::vector<RapidParam*>::iterator it = params_.begin();
 
@@ -705,6 +1056,37 @@ RapidParam* RapidConfig::findParam(TString name) {
 	return 0;
 }
 
+bool RapidConfig::setSmearVariations(unsigned int particle, TString categories) {
+	if(particle >= parts_.size()) {
+		std::cout << "ERROR in RapidConfig::setSmearVariations : particle " << particle << " does not exist." << std::endl;
+		return false;
+	}
+	if(parts_[particle]->nDaughters() != 0) {
+		std::cout << "ERROR in RapidConfig::setSmearVariations : particle " << particle << " is composite - it is not smeared." << std::endl;
+		return false;
+	}
+
+	int from(0);
+	TString category;
+	while(categories.Tokenize(category,from," ")) {
+		if(!momSmearCategories_.count(category) && !ipSmearCategories_.count(category)) {
+			if(!loadSmearing(category) || (!momSmearCategories_.count(category) && !ipSmearCategories_.count(category))) {
+				std::cout << "ERROR in RapidConfig::setSmearVariations : failed to load smearing category " << category << "." << std::endl;
+				return false;
+			}
+		}
+
+		RapidMomentumSmear* momSmear = momSmearCategories_.count(category) ? momSmearCategories_[category] : 0;
+		RapidIPSmear* ipSmear = ipSmearCategories_.count(category) ? ipSmearCategories_[category] : 0;
+
+		std::cout << "INFO in RapidConfig::setSmearVariations : adding smearing variation " << category << " for particle " << particle << std::endl;
+		if(!smearVariations_) smearVariations_ = new RapidSmearVariations();
+		smearVariations_->addVariation(parts_[particle], category, momSmear, ipSmear);
+	}
+
+	return true;
+}
+
 bool RapidConfig::loadSmearing(TString category) {
 	TString path;
 	std::ifstream fin;
@@ -739,7 +1121,7 @@ bool RapidConfig::loadSmearing(TString category) {
 	filename.ReadToken(fin);
 	TFile* file = NULL;
 	if (filename != "NULL") {
-		file = TFile::Open(path+"/rootfiles/smear/"+filename);
+		file = RapidResourceCache::getInstance()->openFile(path+"/rootfiles/smear/"+filename);
 		if(!file) {
 			std::cout << "WARNING in RapidConfig::loadSmearing : failed to load root file " << filename << std::endl;
 			fin.close();
@@ -752,10 +1134,10 @@ bool RapidConfig::loadSmearing(TString category) {
 	if(type=="GAUSS") {
 		TString histname("");
 		histname.ReadToken(fin);
-		TGraphErrors* graph = dynamic_cast<TGraphErrors*>(file->Get(histname));
+		TGraphErrors* graph = dynamic_cast<TGraphErrors*>(RapidResourceCache::getInstance()->getObject(file, histname));
 		if(!graph) {
 			std::cout << "WARNING in RapidConfig::loadSmearing : failed to load graph " << histname << std::endl;
-			file->Close();
+			RapidResourceCache::getInstance()->closeFile(file);
 			fin.close();
 			return false;
 		}
@@ -769,7 +1151,7 @@ bool RapidConfig::loadSmearing(TString category) {
 		fin >> slope;
 		if ((intercept < 0) || (slope < 0) ) {
 			std::cout << "WARNING in RapidConfig::loadSmearing : failed to load IP smearing" << std::endl;
-			file->Close();
+			RapidResourceCache::getInstance()->closeFile(file);
 			fin.close();
 			return false;
 		}
@@ -781,7 +1163,7 @@ bool RapidConfig::loadSmearing(TString category) {
 		fin >> constant;
 		if ((stochastic < 0) || (constant < 0) ) {
 			std::cout << "WARNING in RapidConfig::loadSmearing : failed to load photon smearing" << std::endl;
-			file->Close();
+			RapidResourceCache::getInstance()->closeFile(file);
 			fin.close();
 			return false;
 		}
@@ -790,10 +1172,10 @@ bool RapidConfig::loadSmearing(TString category) {
 	}else if(type=="GAUSSPTETA") {
 		TString histname("");
 		histname.ReadToken(fin);
-		TH2* hist = dynamic_cast<TH2*>(file->Get(histname));
+		TH2* hist = dynamic_cast<TH2*>(RapidResourceCache::getInstance()->getObject(file, histname));
 		if(!hist) {
 			std::cout << "WARNING in RapidConfig::loadSmearing : failed to load histogram " << histname << std::endl;
-			file->Close();
+			RapidResourceCache::getInstance()->closeFile(file);
 			fin.close();
 			return false;
 		}
@@ -811,7 +1193,7 @@ bool RapidConfig::loadSmearing(TString category) {
 			fin >> threshold;
 			histname.ReadToken(fin);
 			if(fin.good()) {
-				TH1* hist = dynamic_cast<TH1*>(file->Get(histname));
+				TH1* hist = dynamic_cast<TH1*>(RapidResourceCache::getInstance()->getObject(file, histname));
 
 				if(!hist || !check1D(hist)) {
 					std::cout << "WARNING in RapidConfig::loadSmearing : failed to load histogram " << histname << std::endl
@@ -828,7 +1210,7 @@ bool RapidConfig::loadSmearing(TString category) {
 
 		if(hists.size() == 0) {
 			std::cout << "WARNING in RapidConfig::loadSmearing : failed to load any histograms for smearing category " << category << std::endl;
-			file->Close();
+			RapidResourceCache::getInstance()->closeFile(file);
 			fin.close();
 			return false;
 		}
@@ -837,7 +1219,7 @@ bool RapidConfig::loadSmearing(TString category) {
 
 	} else {
 		std::cout << "WARNING in RapidConfig::loadSmearing : unknown smearing type. Category " << category << " not added." << std::endl;
-		file->Close();
+		RapidResourceCache::getInstance()->closeFile(file);
 		fin.close();
 		return false;
 	}
@@ -932,8 +1314,8 @@ bool RapidConfig::loadPID(TString category) {
 		while (line.Tokenize(buffer, from)) {
 			if (buffer.Contains(".root") && !fileLoaded) {
 				std::cout << "INFO in RapidConfig::loadPID : loading root file " << buffer << std::endl;
-				if (buffer.BeginsWith("/") || buffer.BeginsWith(".")) file = TFile::Open(buffer);
-				else file = TFile::Open(path+"/rootfiles/pid/"+buffer);
+				if (buffer.BeginsWith("/") || buffer.BeginsWith(".")) file = RapidResourceCache::getInstance()->openFile(buffer);
+				else file = RapidResourceCache::getInstance()->openFile(path+"/rootfiles/pid/"+buffer);
 				fileLoaded = true;
 				if(!file) {
 					std::cout << "WARNING in RapidConfig::loadPID : failed to load root file " << buffer << std::endl;
@@ -949,7 +1331,7 @@ bool RapidConfig::loadPID(TString category) {
 			}
 			if ( fileLoaded && idLoaded && buffer.Contains("Prob")) {
 				std::cout << "INFO in RapidConfig::loadPID : loading histogram " << buffer << std::endl;
-				TH3D * hist = dynamic_cast<TH3D*>(file->Get(buffer));
+				TH3D * hist = dynamic_cast<TH3D*>(RapidResourceCache::getInstance()->getObject(file, buffer));
 				if(!hist) {
 					std::cout << "WARNING in RapidConfig::loadPID : failed to load histogram " << buffer << std::endl;
 					continue;
@@ -967,7 +1349,7 @@ bool RapidConfig::loadPID(TString category) {
 			}
 			if(pidHists_.empty()) {
 				std::cout << "WARNING in RapidConfig::loadPID : failed to load any histograms for PID category " << category << std::endl;
-				file->Close();
+				RapidResourceCache::getInstance()->closeFile(file);
 				fin.close();
 				return false;
 			}
@@ -984,14 +1366,14 @@ bool RapidConfig::loadAcceptRejectHist(TString histFile, TString histName, Rapid
 		return false;
 	}
 
-	TFile* file = TFile::Open(histFile);
+	TFile* file = RapidResourceCache::getInstance()->openFile(histFile);
 	if(!file) {
 		std::cout << "WARNING in RapidConfig::loadAcceptRejectHist : could not open file " << histFile << "." << std::endl
 			  << "                                               path should be absolute or relative to '" << getenv("PWD") << "'." << std::endl
 			  << "                                               accept/reject histogram not set." << std::endl;
 		return false;
 	}
-	TH1* hist = dynamic_cast<TH1*>(file->Get(histName));
+	TH1* hist = dynamic_cast<TH1*>(RapidResourceCache::getInstance()->getObject(file, histName));
 	if(!hist) {
 		std::cout << "WARNING in RapidConfig::loadAcceptRejectHist : could not load histogram " << histName << "." << std::endl
 			  << "                                               accept/reject histogram not set." << std::endl;
@@ -1036,7 +1418,7 @@ bool RapidConfig::loadPVntracks() {
 	if(path!="") {
 		fileName = path;
 		fileName +="/rootfiles/smear/PVNTRACKS.root";
-		file = TFile::Open(fileName);
+		file = RapidResourceCache::getInstance()->openFile(fileName);
 
 		if(file) {
 			std::cout << "INFO in RapidConfig::loadPVntracks : " << fileName << " in RAPIDSIM_CONFIG." << std::endl
@@ -1052,7 +1434,7 @@ bool RapidConfig::loadPVntracks() {
 		path = getenv("RAPIDSIM_ROOT");
 		fileName = path;
 		fileName +="/rootfiles/smear/PVNTRACKS.root";
-		file = TFile::Open(fileName);
+		file = RapidResourceCache::getInstance()->openFile(fileName);
 
 		if(!file) {
 			std::cout << "ERROR in RapidConfig::loadPVntracks : " << fileName << " not found." << std::endl;
@@ -1060,7 +1442,7 @@ bool RapidConfig::loadPVntracks() {
 		}
 	}
 
-	pvHisto_ = dynamic_cast<TH1*>(file->Get("h"));
+	pvHisto_ = dynamic_cast<TH1*>(RapidResourceCache::getInstance()->getObject(file, "h"));
 	if(!pvHisto_) {
 		std::cout << "ERROR in RapidConfig::loadPVntracks : PV ntracks histogram is neither TH1F nor TH1D." << std::endl;
 		return false;
@@ -1070,7 +1452,7 @@ bool RapidConfig::loadPVntracks() {
 }
 
 
-bool RapidConfig::loadParentKinematics() {
+TFile* RapidConfig::openKinematicsFile(double energy) {
 	TString path;
 	TString fileName;
 	TFile* file(0);
@@ -1082,17 +1464,17 @@ bool RapidConfig::loadParentKinematics() {
 		fileName = path;
 		fileName +="/rootfiles/fonll/LHC";
 		fileName += motherFlavour_;
-		fileName += ppEnergy_;
+		fileName += energy;
 		fileName += ".root";
-		file = TFile::Open(fileName);
+		file = RapidResourceCache::getInstance()->openFile(fileName);
 
 		if(file) {
-			std::cout << "INFO in RapidConfig::loadParentKinematics : found kinematics LHC" << motherFlavour_ << ppEnergy_ << " in RAPIDSIM_CONFIG." << std::endl
-				  << "                                            this version will be used." << std::endl;
+			std::cout << "INFO in RapidConfig::openKinematicsFile : found kinematics LHC" << motherFlavour_ << energy << " in RAPIDSIM_CONFIG." << std::endl
+				  << "                                          this version will be used." << std::endl;
 			found = true;
 		} else {
-			std::cout << "INFO in RapidConfig::loadParentKinematics : kinematics LHC" << motherFlavour_ << ppEnergy_ << " not found in RAPIDSIM_CONFIG." << std::endl
-				  << "                                            checking RAPIDSIM_ROOT." << std::endl;
+			std::cout << "INFO in RapidConfig::openKinematicsFile : kinematics LHC" << motherFlavour_ << energy << " not found in RAPIDSIM_CONFIG." << std::endl
+				  << "                                          checking RAPIDSIM_ROOT." << std::endl;
 		}
 	}
 
@@ -1101,19 +1483,26 @@ bool RapidConfig::loadParentKinematics() {
 		fileName = path;
 		fileName += "/rootfiles/fonll/LHC";
 		fileName += motherFlavour_;
-		fileName += ppEnergy_;
+		fileName += energy;
 		fileName += ".root";
-		file = TFile::Open(fileName);
+		file = RapidResourceCache::getInstance()->openFile(fileName);
 
 		if(!file) {
-			std::cout << "ERROR in RapidConfig::loadParentKinematics : unknown kinematics " << motherFlavour_ << "-quark from " << ppEnergy_ << " TeV pp collision." << std::endl
-				  << "                                             file " << fileName << " not found." << std::endl;
-			return false;
+			std::cout << "ERROR in RapidConfig::openKinematicsFile : unknown kinematics " << motherFlavour_ << "-quark from " << energy << " TeV pp collision." << std::endl
+				  << "                                           file " << fileName << " not found." << std::endl;
+			return 0;
 		}
 	}
 
-	TH1* ptHisto = dynamic_cast<TH1*>(file->Get("pT"));
-	TH1* etaHisto = dynamic_cast<TH1*>(file->Get("eta"));
+	return file;
+}
+
+bool RapidConfig::loadParentKinematics() {
+	TFile* file = openKinematicsFile(ppEnergy_);
+	if(!file) return false;
+
+	TH1* ptHisto = dynamic_cast<TH1*>(RapidResourceCache::getInstance()->getObject(file, "pT"));
+	TH1* etaHisto = dynamic_cast<TH1*>(RapidResourceCache::getInstance()->getObject(file, "eta"));
 
 	if(!ptHisto || !check1D(ptHisto)) {
 		std::cout << "ERROR in RapidConfig::loadParentKinematics : pT histogram is neither TH1F nor TH1D." << std::endl;
@@ -1141,6 +1530,10 @@ bool RapidConfig::loadParentKinematics() {
 	ptHisto_ = reduceHistogram(ptHisto,ptMin_,ptMax_);
 	etaHisto_ = reduceHistogram(etaHisto,etaMin_,etaMax_);
 
+	//the full histograms are not needed once they have been reduced
+	if(ptHisto_!=ptHisto) delete ptHisto;
+	if(etaHisto_!=etaHisto) delete etaHisto;
+
 	return true;
 }
 
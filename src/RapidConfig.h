@@ -1,17 +1,25 @@
 #ifndef RAPIDCONFIGPARSER_H
 #define RAPIDCONFIGPARSER_H
 
+#include <istream>
 #include <map>
 #include <vector>
 
+#include "TFile.h"
 #include "TH1.h"
 #include "TH2.h"
 #include "TH3.h"
 #include "TString.h"
 #include "RapidAcceptance.h"
+#include "RapidBeamData.h"
 #include "RapidParam.h"
+#include "RapidParticleData.h"
+#include "RapidTreeSettings.h"
 
 class RapidCut;
+class RapidScan;
+class RapidSmearVariations;
+class RapidWeights;
 class RapidDecay;
 class RapidExternalGenerator;
 class RapidHistWriter;
@@ -21,6 +29,8 @@ class RapidVtxSmear;
 class RapidParam;
 class RapidParticle;
 class RapidPID;
+class RapidMemory;
+class RapidProfiler;
 
 class RapidConfig {
 	public:
@@ -31,35 +41,78 @@ class RapidConfig {
 			  detectorGeometry_(RapidAcceptance::FOURPI),
 			  ppEnergy_(8.), motherFlavour_("b"),
 			  ptHisto_(0), etaHisto_(0), pvHisto_(0), ptMin_(-999.), ptMax_(-999.), etaMin_(-999.), etaMax_(-999.),
-			  maxgen_(1000), decay_(0), acceptance_(0), writer_(0), external_(0), usePhotos_(false)
+			  maxgen_(1000), decay_(0), acceptance_(0), writer_(0), external_(0), usePhotos_(false), keepSeed_(false), scan_(0), weights_(0), smearVariations_(0), profiler_(0)
 		{}
 
 		~RapidConfig();
 
+		//a line in the format of the config file, prefixed by @<index> for a particle setting
+		//applied after the config file has been read
+		void addOverride(TString line) { overrides_.push_back(line); }
+
+		//load <fileName>.decay and <fileName>.config
 		bool load(TString fileName);
+		//load the contents of a .decay and a .config file - name is used for any output
+		bool load(TString name, TString decay, TString config);
 
 		RapidDecay* getDecay();
 		RapidAcceptance* getAcceptance();
 		RapidHistWriter* getWriter(bool saveTree=false);
+		//thresholds to scan over the selected events - 0 if none are configured
+		RapidScan* getScan() { return scan_; }
+		RapidTreeSettings& getTreeSettings() { return treeSettings_; }
+
+		TString outputName();
+		//added to the name of all output files, e.g. to keep those of worker processes apart
+		void setOutputSuffix(TString suffix) { outputSuffix_ = suffix; }
+		bool hasExternalGenerator() { return external_!=0; }
+		//whether the output needs settings or branches beyond the default columns of the tree
+		bool hasTreeOutputSettings() { return !treeSettings_.isDefault() || weights_ || smearVariations_; }
+
+		//keep the current seed rather than seeding from the configuration, e.g. when several modes share one seed
+		void setKeepSeed(bool keep) { keepSeed_ = keep; }
+
+		//reseed the random number generators used to generate events
+		void reseed(unsigned int seed);
+
+		void setProfiler(RapidProfiler* profiler) { profiler_ = profiler; }
+
+		//add the memory held by each subsystem to the current snapshot
+		void measureMemory(RapidMemory& memory);
+
+		//access to individual components, e.g. to benchmark them in isolation
+		const std::vector<RapidParticle*>& getParticles() { return parts_; }
+		RapidMomentumSmear* getMomentumSmearing(TString category);
+		RapidIPSmear* getIPSmearing(TString category);
+		RapidPID* getPID(RapidParam::ParamType type);
 
 	private:
 		bool loadDecay();
+		bool loadDecay(std::istream& in);
 		bool loadConfig();
+		bool loadConfig(std::istream& in);
+		bool completeLoad();
 		void writeConfig();
 
+		bool configLine(unsigned int part, TString line);
 		bool configParticle(unsigned int part, TString command, TString value);
 		bool configGlobal(TString command, TString value);
 		bool loadRange(TString name, TString str, double& min, double& max);
 		RapidParam* loadParam(TString paramStr);
 		RapidCut* loadCut(TString cutStr);
+		bool loadScan(TString scanStr);
+		bool loadWeight(TString weightStr);
+		bool loadWeights();
 
 		RapidParam* findParam(TString name);
 
 		void setSmearing(unsigned int particle, TString category);
+		bool setSmearVariations(unsigned int particle, TString categories);
 		bool loadSmearing(TString category);
 		bool loadPID(TString category);
 
 		bool loadAcceptRejectHist(TString histFile, TString histName, RapidParam* paramX, RapidParam* paramY);
+		TFile* openKinematicsFile(double energy);
 		bool loadParentKinematics();
 		bool loadPVntracks();
 
@@ -72,6 +125,14 @@ class RapidConfig {
 
 		TString fileName_;
     std::string outputDir_;
+		TString outputSuffix_;
+
+		//particle properties and beam conditions used by this configuration
+		RapidParticleData particleData_;
+		RapidBeamData beamData_;
+
+		//settings applied after the config file
+		std::vector<TString> overrides_;
 
 		std::vector<RapidParticle*> parts_;
 
@@ -134,6 +195,9 @@ class RapidConfig {
 		//max attempts to generate
 		double maxgen_;
 
+		//output layout of the tree
+		RapidTreeSettings treeSettings_;
+
 		RapidDecay* decay_;
 		RapidAcceptance* acceptance_;
 		RapidHistWriter* writer_;
@@ -141,6 +205,22 @@ class RapidConfig {
 
 		//flag to track whether an external EvtGen generator should use PHOTOS or not
 		bool usePhotos_;
+
+		//whether the random numbers have already been seeded by the caller
+		bool keepSeed_;
+
+		//cut thresholds to scan
+		RapidScan* scan_;
+
+		//weights for alternative generator settings and the setting of each
+		RapidWeights* weights_;
+		std::vector<TString> weightSettings_;
+
+		//alternative smearing categories applied to each event
+		RapidSmearVariations* smearVariations_;
+
+		//records the time spent in each stage of initialisation
+		RapidProfiler* profiler_;
 };
 
 #endif
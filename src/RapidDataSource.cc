@@ -0,0 +1,130 @@
+#include "RapidDataSource.h"
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#include "RapidGenerator.h"
+
+RapidDataSource::RapidDataSource(RapidGenerator* generator, ULong64_t nParents, ULong64_t nParentsPerChunk)
+	: generator_(generator), nParents_(nParents), nParentsPerChunk_(nParentsPerChunk),
+	  nParentsRemaining_(nParents), nEntries_(0)
+{
+	if(nParentsPerChunk_==0) nParentsPerChunk_ = 1;
+
+	const std::vector<TString>& columns = generator_->columns();
+	for(unsigned int i=0; i<columns.size(); ++i) {
+		columnNames_.push_back(columns[i].Data());
+	}
+
+	SetNSlots(1);
+}
+
+RapidDataSource::~RapidDataSource() {
+	delete generator_;
+}
+
+void RapidDataSource::SetNSlots(unsigned int nSlots) {
+	chunks_.assign(nSlots, RapidEventBatch());
+	chunkStart_.assign(nSlots, 0);
+	slotChunk_.assign(nSlots, 0);
+	slotValues_.assign(nSlots, std::vector<const double*>(columnNames_.size(), static_cast<const double*>(0)));
+}
+
+bool RapidDataSource::HasColumn(std::string_view name) const {
+	for(unsigned int i=0; i<columnNames_.size(); ++i) {
+		if(columnNames_[i]==name) return true;
+	}
+	return false;
+}
+
+std::string RapidDataSource::GetTypeName(std::string_view name) const {
+	if(!HasColumn(name)) {
+		throw std::runtime_error("RapidDataSource : column " + std::string(name) + " does not exist");
+	}
+	return "double";
+}
+
+std::vector<void*> RapidDataSource::GetColumnReadersImpl(std::string_view name, const std::type_info& type) {
+	if(type!=typeid(double)) {
+		throw std::runtime_error("RapidDataSource : column " + std::string(name) + " is of type double");
+	}
+
+	unsigned int column(0);
+	for( ; column<columnNames_.size(); ++column) {
+		if(columnNames_[column]==name) break;
+	}
+	if(column==columnNames_.size()) {
+		throw std::runtime_error("RapidDataSource : column " + std::string(name) + " does not exist");
+	}
+
+	std::vector<void*> readers;
+	for(unsigned int slot=0; slot<slotValues_.size(); ++slot) {
+		readers.push_back(&slotValues_[slot][column]);
+	}
+	return readers;
+}
+
+void RapidDataSource::Initialise() {
+	nParentsRemaining_ = nParents_;
+	nEntries_ = 0;
+}
+
+std::vector<std::pair<ULong64_t, ULong64_t> > RapidDataSource::GetEntryRanges() {
+	std::vector<std::pair<ULong64_t, ULong64_t> > ranges;
+
+	//an empty set of ranges ends the event loop so keep going until something is selected
+	while(ranges.empty() && nParentsRemaining_>0) {
+		for(unsigned int i=0; i<chunks_.size() && nParentsRemaining_>0; ++i) {
+			ULong64_t nParents = nParentsPerChunk_;
+			if(nParents>nParentsRemaining_) nParents = nParentsRemaining_;
+			nParentsRemaining_ -= nParents;
+
+			chunks_[i].clear();
+			generator_->generate(static_cast<int>(nParents), chunks_[i]);
+			if(chunks_[i].size()==0) continue;
+
+			chunkStart_[i] = nEntries_;
+			nEntries_ += chunks_[i].size();
+			ranges.push_back(std::make_pair(chunkStart_[i], nEntries_));
+		}
+	}
+
+	return ranges;
+}
+
+void RapidDataSource::InitSlot(unsigned int slot, ULong64_t firstEntry) {
+	//ranges are not tied to slots so find the chunk this slot has been given
+	for(unsigned int i=0; i<chunks_.size(); ++i) {
+		if(chunks_[i].size()>0 && chunkStart_[i]==firstEntry) {
+			slotChunk_[slot] = i;
+			return;
+		}
+	}
+	std::cout << "ERROR in RapidDataSource::InitSlot : no chunk starts at entry " << firstEntry << "." << std::endl;
+}
+
+bool RapidDataSource::SetEntry(unsigned int slot, ULong64_t entry) {
+	const RapidEventBatch& chunk = chunks_[slotChunk_[slot]];
+	ULong64_t event = entry - chunkStart_[slotChunk_[slot]];
+	if(event>=chunk.size()) return false;
+
+	std::vector<const double*>& values = slotValues_[slot];
+	for(unsigned int i=0; i<values.size(); ++i) {
+		values[i] = &chunk.column(i)[event];
+	}
+	return true;
+}
+
+ROOT::RDataFrame MakeRapidDataFrame(TString mode, ULong64_t nParents, const std::vector<TString>& settings) {
+	RapidGenerator* generator = new RapidGenerator();
+	for(unsigned int i=0; i<settings.size(); ++i) {
+		generator->addSetting(settings[i]);
+	}
+	if(!generator->load(mode)) {
+		delete generator;
+		throw std::runtime_error("MakeRapidDataFrame : failed to load decay mode " + std::string(mode.Data()));
+	}
+
+	return ROOT::RDataFrame(std::unique_ptr<ROOT::RDF::RDataSource>(new RapidDataSource(generator, nParents)));
+}
@@ -0,0 +1,73 @@
+#ifndef RAPIDDATASOURCE_H
+#define RAPIDDATASOURCE_H
+
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RDataSource.hxx"
+#include "TString.h"
+
+#include "RapidEventBatch.h"
+
+class RapidGenerator;
+
+//an RDataFrame data source that generates RapidSim events as they are requested rather than reading them from a file
+//
+//the columns have the names of the histograms and tree branches written by RapidSim.exe and are all of type double
+//each call to GetEntryRanges generates one chunk of parents for each slot, which the slots then process in parallel
+//the generation itself is done by a single generator outside of the slots as the generators share gRandom
+//every event loop run over the data frame generates a new sample of nParents
+class RapidDataSource : public ROOT::RDF::RDataSource {
+	public:
+		//takes ownership of a loaded generator
+		RapidDataSource(RapidGenerator* generator, ULong64_t nParents, ULong64_t nParentsPerChunk=10000);
+
+		~RapidDataSource();
+
+		virtual void SetNSlots(unsigned int nSlots);
+		virtual const std::vector<std::string>& GetColumnNames() const { return columnNames_; }
+		virtual bool HasColumn(std::string_view name) const;
+		virtual std::string GetTypeName(std::string_view name) const;
+
+		virtual std::vector<std::pair<ULong64_t, ULong64_t> > GetEntryRanges();
+		virtual bool SetEntry(unsigned int slot, ULong64_t entry);
+
+		virtual void Initialise();
+		virtual void InitSlot(unsigned int slot, ULong64_t firstEntry);
+
+		virtual std::string GetLabel() { return "RapidSim"; }
+
+	protected:
+		virtual std::vector<void*> GetColumnReadersImpl(std::string_view name, const std::type_info& type);
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidDataSource( const RapidDataSource& other );
+		RapidDataSource& operator=( const RapidDataSource& other );
+
+		RapidGenerator* generator_;
+
+		ULong64_t nParents_;
+		ULong64_t nParentsPerChunk_;
+		ULong64_t nParentsRemaining_;
+		ULong64_t nEntries_;
+
+		std::vector<std::string> columnNames_;
+
+		//one chunk of selected events for each slot and the entry number of its first event
+		std::vector<RapidEventBatch> chunks_;
+		std::vector<ULong64_t> chunkStart_;
+
+		//the chunk being read by each slot and a pointer to the current value of each column
+		std::vector<unsigned int> slotChunk_;
+		std::vector<std::vector<const double*> > slotValues_;
+};
+
+//an RDataFrame over nParents parents generated from <mode>.decay and <mode>.config
+ROOT::RDataFrame MakeRapidDataFrame(TString mode, ULong64_t nParents, const std::vector<TString>& settings=std::vector<TString>());
+
+#endif
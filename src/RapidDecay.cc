@@ -12,6 +12,9 @@
 #include "RapidParam.h"
 #include "RapidParticle.h"
 #include "RapidParticleData.h"
+#include "RapidProfiler.h"
+#include "RapidSmearVariations.h"
+#include "RapidTruthInput.h"
 #include "RapidBeamData.h"
 #include "RapidVertex.h"
 
@@ -69,8 +72,37 @@ bool RapidDecay::generate(bool genpar) {
 	//keep resonance masses and parent kinematics independent of the accept/reject decision
 	//these will only be biased if the function is very inefficient for certain values
 	//however, one should not use an a/r function the is highly correlated to these variables
-	floatMasses();
-	if (genpar) genParent();
+	//when re-decaying a sub-chain only that part of the decay is regenerated
+	bool partial = !genpar && reDecayParticle_>=0;
+
+	if(profiler_) profiler_->start(RapidProfiler::FLOATMASSES);
+	floatMasses(partial);
+	if(profiler_) profiler_->stop(RapidProfiler::FLOATMASSES);
+
+	if (genpar) {
+		if(profiler_) profiler_->start(RapidProfiler::GENPARENT);
+		genParent();
+		if(profiler_) profiler_->stop(RapidProfiler::GENPARENT);
+	}
+
+	if(profiler_) profiler_->start(RapidProfiler::GENDECAY);
+	bool decayed = generateDecay(partial);
+	if(profiler_) profiler_->stop(RapidProfiler::GENDECAY);
+	if(!decayed) return false;
+
+	if(profiler_) profiler_->start(RapidProfiler::SMEARMOMENTA);
+	smearMomenta(partial);
+	if(profiler_) profiler_->stop(RapidProfiler::SMEARMOMENTA);
+
+	if(profiler_) profiler_->start(RapidProfiler::CALCIPS);
+	calcIPs(partial);
+	if(profiler_) profiler_->stop(RapidProfiler::CALCIPS);
+
+	return true;
+}
+
+bool RapidDecay::generateDecay(bool partial) {
+	if(partial && reDecayKeep_) saveKeptChain();
 
 	bool decayed(false);
 	if(external_) {
@@ -79,33 +111,126 @@ bool RapidDecay::generate(bool genpar) {
 
 	if(!decayed) {
 		if(accRejHisto_) {
-			if(!genDecayAccRej()) return false;
-
+			decayed = genDecayAccRej(partial);
 		} else {
-			if(!genDecay()) return false;
+			decayed = genDecay(false, partial);
+		}
+	}
+	return decayed;
+}
+
+bool RapidDecay::generateResponse(RapidTruthInput* truth) {
+	if(profiler_) profiler_->start(RapidProfiler::GENDECAY);
+	bool read = truth->next();
+	if(read && !truth->hasVertices()) {
+		for(unsigned int i=0; i<parts_.size(); ++i) {
+			if(parts_[i]->nDaughters()>0) genDecayVertex(parts_[i]);
 		}
 	}
+	if(profiler_) profiler_->stop(RapidProfiler::GENDECAY);
+	if(!read) return false;
+
+	if(profiler_) profiler_->start(RapidProfiler::GENPARENT);
+	genPileup();
+	if(profiler_) profiler_->stop(RapidProfiler::GENPARENT);
 
+	if(profiler_) profiler_->start(RapidProfiler::SMEARMOMENTA);
 	smearMomenta();
+	if(profiler_) profiler_->stop(RapidProfiler::SMEARMOMENTA);
+
+	if(profiler_) profiler_->start(RapidProfiler::CALCIPS);
 	calcIPs();
+	if(profiler_) profiler_->stop(RapidProfiler::CALCIPS);
 
 	return true;
 }
 
-void RapidDecay::smearMomenta() {
+bool RapidDecay::setReDecayParticle(unsigned int index, bool keep) {
+	if(index==0 || index>=parts_.size() || parts_[index]->nDaughters()==0) {
+		std::cout << "ERROR in RapidDecay::setReDecayParticle : particle " << index << " is not an intermediate particle of the decay." << std::endl;
+		return false;
+	}
+	if(external_) {
+		std::cout << "ERROR in RapidDecay::setReDecayParticle : sub-chains cannot be re-decayed with an external generator." << std::endl;
+		return false;
+	}
+
+	RapidParticle* head = parts_[index];
+	reDecayFloat_.assign(parts_.size(), false);
+	reDecayGen_.assign(parts_.size(), false);
+	reDecaySmear_.assign(parts_.size(), keep);
+
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		//find whether the particle is in the sub-chain or is above it
+		bool inChain(false);
+		for(RapidParticle* part=parts_[i]; part!=0; part=part->mother()) {
+			if(part==head) {
+				inChain = true;
+				break;
+			}
+		}
+		bool above(false);
+		for(RapidParticle* part=head->mother(); part!=0; part=part->mother()) {
+			if(part==parts_[i]) {
+				above = true;
+				break;
+			}
+		}
+
+		if(keep) {
+			//the mass of the head is kept as it fixes the decay of the sub-chain
+			reDecayFloat_[i] = !inChain;
+			reDecayGen_[i] = !inChain;
+		} else {
+			reDecayFloat_[i] = inChain && parts_[i]!=head;
+			reDecayGen_[i] = inChain;
+			//mothers of the sub-chain are reconstructed from its smeared momenta
+			reDecaySmear_[i] = inChain || above;
+		}
+	}
+
+	reDecayParticle_ = index;
+	reDecayKeep_ = keep;
+	keptMomenta_.assign(parts_.size(), TLorentzVector());
+
+	std::cout << "INFO in RapidDecay::setReDecayParticle : re-decays will " << (keep ? "keep" : "only regenerate") << " the decay of " << head->name() << std::endl;
+	return true;
+}
+
+void RapidDecay::smear(bool partial) {
+	smearMomenta(partial);
+	calcIPs(partial);
+}
+
+void RapidDecay::smearAll() {
+	parts_[0]->getOriginVertex()->smearVertex();
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		if(parts_[i]->nDaughters()>0 && parts_[i]->ctau()>0) parts_[i]->getDecayVertex()->smearVertex();
+	}
+	for(unsigned int i=0; i<pileuppvs_.size(); ++i) {
+		pileuppvs_[i].smearVertex();
+	}
+	smear();
+}
+
+void RapidDecay::smearMomenta(bool partial) {
+	if(variations_) variations_->saveRandomState(partial);
+
 	//run backwards so that we reach the daughters first
 	for(int i=parts_.size()-1; i>=0; --i) {//don't change to unsigned - needs to hit -1 to break loop
+		if(partial && !reDecaySmear_[i]) continue;
 		parts_[i]->smearMomentum();
 	}
 
 }
 
-void RapidDecay::calcIPs() {
+void RapidDecay::calcIPs(bool partial) {
 	//The origin vertex of the signal is always 0,0,0
 	RapidVertex * signalpv = parts_[0]->getOriginVertex();
 	std::vector<RapidParticle*>::iterator itrPart;
 
 	for(itrPart = parts_.begin(); itrPart!=parts_.end(); ++itrPart) {
+		if(partial && !reDecaySmear_[itrPart-parts_.begin()]) continue;
 		RapidParticle* part = (*itrPart);
 		double ip(0.);
 		ip = getParticleIP(signalpv->getVertex(true),part->getOriginVertex()->getVertex(true),part->getP());
@@ -152,17 +277,16 @@ void RapidDecay::setup() {
 	}
 }
 
-void RapidDecay::floatMasses() {
+void RapidDecay::floatMasses(bool partial) {
 	for(unsigned int i=0; i<parts_.size(); ++i) {
+		if(partial && !reDecayFloat_[i]) continue;
 		parts_[i]->floatMass();
 	}
 }
 
 void RapidDecay::setupMasses() {
-	RapidParticleData* particleData = RapidParticleData::getInstance();
-
 	for(unsigned int i=0; i<parts_.size(); ++i) {
-		particleData->setupMass(parts_[i]);
+		particleData_->setupMass(parts_[i]);
 	}
 }
 
@@ -228,18 +352,21 @@ TH2* RapidDecay::generateAccRejDenominator2D() {
 
 void RapidDecay::genParent() {
 	double pt(0), eta(0), phi(gRandom->Uniform(0,2*TMath::Pi()));
-	unsigned int nPVtracks(5);
 	if(ptHisto_)   pt = ptHisto_->GetRandom();
 	if(etaHisto_) eta = etaHisto_->GetRandom();
 	parts_[0]->setPtEtaPhi(pt,eta,phi);
+	genPileup();
+}
+
+void RapidDecay::genPileup() {
+	unsigned int nPVtracks(5);
 	if(pvHisto_) nPVtracks = pvHisto_->GetRandom();
 	parts_[0]->getOriginVertex()->setNtracks(nPVtracks);
 
 	//Now the pileup vertices
-	RapidBeamData* beam = RapidBeamData::getInstance();
-	unsigned int numpileup_ = gRandom->Poisson(beam->getPileup());
-	double sigmapvxy_ = beam->getSigmaXY();
-	double sigmapvz_  = beam->getSigmaZ();
+	unsigned int numpileup_ = gRandom->Poisson(beamData_->getPileup());
+	double sigmapvxy_ = beamData_->getSigmaXY();
+	double sigmapvz_  = beamData_->getSigmaZ();
 
 	pileuppvs_.clear();
 	for(unsigned int i=0; i<numpileup_; ++i) {
@@ -250,8 +377,10 @@ void RapidDecay::genParent() {
 	}
 }
 
-bool RapidDecay::genDecay(bool acceptAny) {
+bool RapidDecay::genDecay(bool acceptAny, bool partial) {
+	int nAttempts(0);
 	for(unsigned int i=0; i<parts_.size(); ++i) {
+		if(partial && !reDecayGen_[i]) continue;
 		RapidParticle* part = parts_[i];
 		if(part->nDaughters()>0) {
 			// check decay kinematics valid
@@ -267,7 +396,9 @@ bool RapidDecay::genDecay(bool acceptAny) {
 
 			// make an event
 			if(acceptAny) {
+				//the weight is applied by the accept/reject histogram instead
 				decay_.Generate();
+				++nAttempts;
 			} else {
 				int nGen(0);
 				bool accept(false);
@@ -275,8 +406,10 @@ bool RapidDecay::genDecay(bool acceptAny) {
 					accept = decay_.Generate() > gRandom->Uniform();
 					++nGen;
 				} // while
+				nAttempts += nGen;
 
 				if(!accept) {
+					if(profiler_) profiler_->fillAttempts(nAttempts);
 					if(!suppressAttemptsWarning_) {
 						std::cout << "WARNING in RapidDecay::genDecay : rejected all " << maxgen_ << " attempts to decay " << part->name() << "." << std::endl
 							  << "                                  this event will not be generated." << std::endl
@@ -289,13 +422,7 @@ bool RapidDecay::genDecay(bool acceptAny) {
 			// Now generate the decay vertex for long-lived particles
 			// First set the origin vertex to be the PV for the head of the chain
 			// in all other cases, the origin vertex will already be set in the loop below
-			if (part->ctau()>0) {
-				double dist = part->getP().P()*gRandom->Exp(part->ctau())/part->mass();
-				double dvx  = part->getOriginVertex()->getVertex(true).X() + part->getP().Vect().Unit().X()*dist;
-				double dvy  = part->getOriginVertex()->getVertex(true).Y() + part->getP().Vect().Unit().Y()*dist;
-				double dvz  = part->getOriginVertex()->getVertex(true).Z() + part->getP().Vect().Unit().Z()*dist;
-				part->getDecayVertex()->setXYZ(dvx,dvy,dvz);
-			}
+			genDecayVertex(part);
 
 			int j=0;
 			for(RapidParticle* jDaug=part->daughter(0); jDaug!=0; jDaug=jDaug->next()) {
@@ -304,9 +431,48 @@ bool RapidDecay::genDecay(bool acceptAny) {
 		}
 	}
 
+	if(profiler_) profiler_->fillAttempts(nAttempts);
+
+	if(partial && reDecayKeep_) boostKeptChain();
+
 	return true;
 }
 
+void RapidDecay::genDecayVertex(RapidParticle* part) {
+	if (part->ctau()>0) {
+		double dist = part->getP().P()*gRandom->Exp(part->ctau())/part->mass();
+		double dvx  = part->getOriginVertex()->getVertex(true).X() + part->getP().Vect().Unit().X()*dist;
+		double dvy  = part->getOriginVertex()->getVertex(true).Y() + part->getP().Vect().Unit().Y()*dist;
+		double dvz  = part->getOriginVertex()->getVertex(true).Z() + part->getP().Vect().Unit().Z()*dist;
+		part->getDecayVertex()->setXYZ(dvx,dvy,dvz);
+	}
+}
+
+void RapidDecay::saveKeptChain() {
+	TVector3 boost = -parts_[reDecayParticle_]->getP().BoostVector();
+	for(unsigned int i=reDecayParticle_+1; i<parts_.size(); ++i) {
+		if(reDecayGen_[i]) continue;
+		keptMomenta_[i] = parts_[i]->getP();
+		keptMomenta_[i].Boost(boost);
+	}
+}
+
+void RapidDecay::boostKeptChain() {
+	RapidParticle* head = parts_[reDecayParticle_];
+	TVector3 boost = head->getP().BoostVector();
+	genDecayVertex(head);
+
+	//mothers come before their daughters so each origin vertex is set before it is used
+	for(unsigned int i=reDecayParticle_+1; i<parts_.size(); ++i) {
+		if(reDecayGen_[i]) continue;
+		RapidParticle* part = parts_[i];
+		TLorentzVector p = keptMomenta_[i];
+		p.Boost(boost);
+		part->setP(p);
+		if(part->nDaughters()>0) genDecayVertex(part);
+	}
+}
+
 double RapidDecay::getParticleIP(ROOT::Math::XYZPoint pv, ROOT::Math::XYZPoint dv, TLorentzVector p) {
 	ROOT::Math::XYZVector v1 = pv - dv;
 	ROOT::Math::XYZVector lengthv(p.X(), p.Y(), p.Z());
@@ -317,17 +483,19 @@ double RapidDecay::getParticleIP(ROOT::Math::XYZPoint pv, ROOT::Math::XYZPoint d
 	return sqrt(impact.Mag2());
 }
 
-bool RapidDecay::genDecayAccRej() {
+bool RapidDecay::genDecayAccRej(bool partial) {
 	bool passAccRej(true);
 	int ntry(0);
 
 	do {
-		if(!genDecay(true)) return false;
+		if(!genDecay(true, partial)) return false;
 		passAccRej = runAcceptReject();
 		++ntry;
 
 	} while(!passAccRej && ntry<maxgen_);
 
+	if(profiler_) profiler_->fillAccRejTries(ntry);
+
 	if(!passAccRej) {
 		if(!suppressAttemptsWarning_) {
 			std::cout << "WARNING in RapidDecay::genDecayAccRej : no events found with required kinematics." << std::endl
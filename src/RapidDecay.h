@@ -15,19 +15,25 @@
 
 #include "RapidVertex.h"
 
+class RapidBeamData;
 class RapidParticle;
+class RapidParticleData;
 class RapidParam;
 class RapidExternalGenerator;
+class RapidProfiler;
+class RapidSmearVariations;
+class RapidTruthInput;
 
 class RapidDecay {
 	public:
-		RapidDecay(const std::vector<RapidParticle*>& parts)
-			: parts_(parts), maxgen_(1000),
+		RapidDecay(const std::vector<RapidParticle*>& parts, RapidParticleData* particleData, RapidBeamData* beamData)
+			: parts_(parts), particleData_(particleData), beamData_(beamData), maxgen_(1000),
 			  ptHisto_(0), etaHisto_(0),
 			  pvHisto_(0),
 			  accRejHisto_(0), accRejParameterX_(0), accRejParameterY_(0),
 			  suppressKinematicWarning_(false), suppressAttemptsWarning_(false),
-			  external_(0)
+			  reDecayParticle_(-1), reDecayKeep_(false),
+			  external_(0), profiler_(0), variations_(0)
 			{setup();}
 
 		~RapidDecay() {}
@@ -38,9 +44,26 @@ class RapidDecay {
 		void setAcceptRejectHist(TH1* histo, RapidParam* param);
 		void setAcceptRejectHist(TH1* histo, RapidParam* paramX, RapidParam* paramY);
 		void setExternal(RapidExternalGenerator* external);
+		void setProfiler(RapidProfiler* profiler) { profiler_ = profiler; }
+		void setSmearVariations(RapidSmearVariations* variations) { variations_ = variations; }
 
 		bool checkDecay();
 		bool generate(bool genpar=true);
+		//decay the current parent, or with partial the re-decayed sub-chain, without floating masses or smearing
+		bool generateDecay(bool partial=false);
+		//read the next true decay and simulate only the pileup and detector response - false once the input is exhausted
+		bool generateResponse(RapidTruthInput* truth);
+
+		//re-decay only the sub-chain below a particle, or with keep everything except that sub-chain
+		bool setReDecayParticle(unsigned int index, bool keep=false);
+		//smear the current decay again, e.g. after its smearing functions have changed - partial only redoes the particles
+		//that are re-decayed
+		void smear(bool partial=false);
+		//smear the vertices as well as the momenta and IPs again from their true values
+		void smearAll();
+
+		//pileup vertices of the current event
+		std::vector<RapidVertex>& pileupVertices() { return pileuppvs_; }
 
 	private:
 		void setup();
@@ -54,17 +77,27 @@ class RapidDecay {
 		TH1* generateAccRejDenominator1D();
 		TH2* generateAccRejDenominator2D();
 
-		void floatMasses();
+		void floatMasses(bool partial=false);
 		void genParent();
-		bool genDecay(bool acceptAny=false);
-		bool genDecayAccRej();
-		void smearMomenta();
-		void calcIPs();
+		void genPileup();
+		bool genDecay(bool acceptAny=false, bool partial=false);
+		bool genDecayAccRej(bool partial=false);
+		void genDecayVertex(RapidParticle* part);
+		void smearMomenta(bool partial=false);
+		void calcIPs(bool partial=false);
+
+		//move the kept sub-chain with its head after the rest of the chain has been re-decayed
+		void saveKeptChain();
+		void boostKeptChain();
 		double getParticleIP(ROOT::Math::XYZPoint, ROOT::Math::XYZPoint, TLorentzVector);
 
 		//the particles
 		std::vector<RapidParticle*> parts_;
 
+		//particle properties and beam conditions of the run
+		RapidParticleData* particleData_;
+		RapidBeamData* beamData_;
+
 		//pileup vertices
 		std::vector<RapidVertex> pileuppvs_;
 
@@ -90,8 +123,25 @@ class RapidDecay {
 		bool suppressKinematicWarning_;
 		bool suppressAttemptsWarning_;
 
+		//particle whose sub-chain is re-decayed, or kept, or -1 to re-decay the full chain
+		int reDecayParticle_;
+		bool reDecayKeep_;
+
+		//whether each particle's mass is floated, its decay generated and its smearing redone when re-decaying
+		std::vector<bool> reDecayFloat_;
+		std::vector<bool> reDecayGen_;
+		std::vector<bool> reDecaySmear_;
+
+		//momenta of the kept sub-chain in the rest frame of its head
+		std::vector<TLorentzVector> keptMomenta_;
+
 		//external decay generator wrapper
 		RapidExternalGenerator* external_;
 
+		//records the time spent in each stage of generation
+		RapidProfiler* profiler_;
+
+		//smearing variations that replay the random numbers of the nominal smearing
+		RapidSmearVariations* variations_;
 };
 #endif
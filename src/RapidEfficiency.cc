@@ -0,0 +1,120 @@
+#include "RapidEfficiency.h"
+
+#include <fstream>
+#include <iostream>
+
+#include "TEfficiency.h"
+#include "TSystem.h"
+
+#include "RapidAcceptance.h"
+
+bool RapidEfficiency::intervalFromString(TString str, RapidEfficiency::IntervalType& type) {
+	str.ToLower();
+	if(str=="wilson") {
+		type = RapidEfficiency::WILSON;
+	} else if(str=="clopper-pearson" || str=="clopperpearson") {
+		type = RapidEfficiency::CLOPPERPEARSON;
+	} else {
+		std::cout << "ERROR in RapidEfficiency::intervalFromString : unknown interval type " << str << "." << std::endl
+			  << "                                              options are wilson or clopper-pearson." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+double RapidEfficiency::uncertainty() {
+	double maxUncertainty = relativeUncertainty(acceptance_->nTested(), acceptance_->nSelected());
+	if(!perCut_) return maxUncertainty;
+
+	//each stage is relative to the events passing the previous stage
+	Long64_t total = acceptance_->nTested();
+	Long64_t passed = acceptance_->nInAcceptance();
+	double stageUncertainty = relativeUncertainty(total, passed);
+	if(stageUncertainty > maxUncertainty) maxUncertainty = stageUncertainty;
+
+	for(unsigned int i=0; i<acceptance_->nCuts(); ++i) {
+		total = passed;
+		passed = acceptance_->nPassCut(i);
+		stageUncertainty = relativeUncertainty(total, passed);
+		if(stageUncertainty > maxUncertainty) maxUncertainty = stageUncertainty;
+	}
+
+	return maxUncertainty;
+}
+
+void RapidEfficiency::print() {
+	double eff(0.), low(0.), high(0.);
+	Long64_t total = acceptance_->nTested();
+	Long64_t passed = acceptance_->nSelected();
+	interval(total, passed, eff, low, high);
+
+	std::cout << "INFO in RapidEfficiency::print : efficiency is " << passed << "/" << total << " = " << eff << std::endl
+		  << "                                 " << 100.*cl_ << "% interval is [" << low << ", " << high << "]" << std::endl;
+}
+
+bool RapidEfficiency::write(TString fileName) {
+	std::cout << "INFO in RapidEfficiency::write : writing efficiency summary to file: " << fileName << std::endl;
+
+	std::ofstream fout;
+	fout.open(fileName+".tmp", std::ofstream::out);
+	if(!fout.good()) {
+		std::cout << "ERROR in RapidEfficiency::write : failed to open file " << fileName << "." << std::endl;
+		return false;
+	}
+
+	fout << "# interval " << (type_==RapidEfficiency::WILSON ? "Wilson" : "Clopper-Pearson") << " with confidence level " << cl_ << "\n";
+	fout << "# target relative uncertainty " << target_ << (perCut_ ? " on each stage" : " on the total") << "\n";
+	fout << "# stage efficiencies are relative to the previous stage\n";
+	fout << "# passed\ttotal\tefficiency\tlower\tupper\tstage\n";
+
+	double eff(0.), low(0.), high(0.);
+	Long64_t total = acceptance_->nTested();
+	Long64_t passed = acceptance_->nInAcceptance();
+	interval(total, passed, eff, low, high);
+	fout << passed << "\t" << total << "\t" << eff << "\t" << low << "\t" << high << "\tacceptance\n";
+
+	for(unsigned int i=0; i<acceptance_->nCuts(); ++i) {
+		total = passed;
+		passed = acceptance_->nPassCut(i);
+		interval(total, passed, eff, low, high);
+		fout << passed << "\t" << total << "\t" << eff << "\t" << low << "\t" << high << "\tcut " << acceptance_->cutName(i) << "\n";
+	}
+
+	total = acceptance_->nTested();
+	interval(total, passed, eff, low, high);
+	fout << passed << "\t" << total << "\t" << eff << "\t" << low << "\t" << high << "\ttotal\n";
+	fout.close();
+
+	gSystem->Rename(fileName+".tmp", fileName);
+	return true;
+}
+
+void RapidEfficiency::interval(Long64_t total, Long64_t passed, double& eff, double& low, double& high) {
+	if(total<=0) {
+		eff = 0.;
+		low = 0.;
+		high = 1.;
+		return;
+	}
+
+	eff = static_cast<double>(passed)/total;
+	switch(type_) {
+		case RapidEfficiency::CLOPPERPEARSON:
+			low  = TEfficiency::ClopperPearson(total, passed, cl_, false);
+			high = TEfficiency::ClopperPearson(total, passed, cl_, true);
+			break;
+		case RapidEfficiency::WILSON:
+		default:
+			low  = TEfficiency::Wilson(total, passed, cl_, false);
+			high = TEfficiency::Wilson(total, passed, cl_, true);
+	}
+}
+
+double RapidEfficiency::relativeUncertainty(Long64_t total, Long64_t passed) {
+	//no meaningful relative uncertainty until something has passed
+	if(passed<=0) return 1.e30;
+
+	double eff(0.), low(0.), high(0.);
+	interval(total, passed, eff, low, high);
+	return 0.5*(high-low)/eff;
+}
@@ -0,0 +1,49 @@
+#ifndef RAPIDEFFICIENCY_H
+#define RAPIDEFFICIENCY_H
+
+#include "TString.h"
+
+class RapidAcceptance;
+
+class RapidEfficiency {
+	public:
+		enum IntervalType {
+			WILSON,
+			CLOPPERPEARSON
+		};
+
+		static bool intervalFromString(TString str, RapidEfficiency::IntervalType& type);
+
+		RapidEfficiency(RapidAcceptance* acceptance, double target, bool perCut=false, IntervalType type=WILSON, double cl=0.682689492137)
+			: acceptance_(acceptance), target_(target), perCut_(perCut), type_(type), cl_(cl)
+			{}
+
+		~RapidEfficiency() {}
+
+		bool targetReached() { return uncertainty() <= target_; }
+
+		//largest relative uncertainty of the efficiencies the target applies to
+		double uncertainty();
+		double target() { return target_; }
+
+		void print();
+		bool write(TString fileName);
+
+	private:
+		void interval(Long64_t total, Long64_t passed, double& eff, double& low, double& high);
+		double relativeUncertainty(Long64_t total, Long64_t passed);
+
+		RapidAcceptance* acceptance_;
+
+		//target relative uncertainty on the efficiency
+		double target_;
+
+		//whether the target also applies to the efficiency of each stage of the selection
+		bool perCut_;
+
+		//type of interval and its confidence level
+		IntervalType type_;
+		double cl_;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef RAPIDEVENTBATCH_H
+#define RAPIDEVENTBATCH_H
+
+#include <vector>
+
+#include "TString.h"
+
+//a batch of selected events stored as one contiguous column of values for each parameter
+class RapidEventBatch {
+	public:
+		RapidEventBatch()
+			: nEvents_(0)
+			{}
+
+		~RapidEventBatch() {}
+
+		unsigned int size() const { return nEvents_; }
+		unsigned int nColumns() const { return names_.size(); }
+
+		//names of the columns, as the histograms and tree branches written by RapidSim.exe
+		const std::vector<TString>& names() const { return names_; }
+		int columnIndex(TString name) const {
+			for(unsigned int i=0; i<names_.size(); ++i) {
+				if(names_[i]==name) return i;
+			}
+			return -1;
+		}
+
+		//the values of one column for every event in the batch
+		const std::vector<double>& column(unsigned int i) const { return columns_[i]; }
+		double value(unsigned int event, unsigned int i) const { return columns_[i][event]; }
+
+		//remove the events but keep the columns and their memory
+		void clear() {
+			for(unsigned int i=0; i<columns_.size(); ++i) {
+				columns_[i].clear();
+			}
+			nEvents_ = 0;
+		}
+
+		void reserve(unsigned int nEvents) {
+			for(unsigned int i=0; i<columns_.size(); ++i) {
+				columns_[i].reserve(nEvents);
+			}
+		}
+
+		void setColumns(const std::vector<TString>& names) {
+			names_ = names;
+			columns_ = std::vector<std::vector<double> >(names.size());
+			nEvents_ = 0;
+		}
+
+		void addEvent(const std::vector<double>& values) {
+			for(unsigned int i=0; i<columns_.size(); ++i) {
+				columns_[i].push_back(values[i]);
+			}
+			++nEvents_;
+		}
+
+	private:
+		std::vector<TString> names_;
+		std::vector<std::vector<double> > columns_;
+		unsigned int nEvents_;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "RapidExternalEvtGen.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
 #include <queue>
@@ -16,11 +17,21 @@
 #include "EvtGenBase/EvtParticleFactory.hh"
 #include "EvtGenBase/EvtPatches.hh"
 #include "EvtGenBase/EvtPDL.hh"
+#include "EvtGenBase/EvtRandom.hh"
 #include "EvtGenBase/EvtMTRandomEngine.hh"
 
 #include "EvtGenExternal/EvtExternalGenList.hh"
 #endif
 
+#include "RapidResourceCache.h"
+
+#ifdef RAPID_EVTGEN
+EvtGen* RapidExternalEvtGen::sharedEvtGen_=0;
+std::vector<TString> RapidExternalEvtGen::sharedDecayNames_;
+bool RapidExternalEvtGen::newJob_=true;
+EvtRandomEngine* RapidExternalEvtGen::randomEngine_=0;
+#endif
+
 bool RapidExternalEvtGen::decay(std::vector<RapidParticle*>& parts) {
 #ifdef RAPID_EVTGEN
 	EvtParticle* theParent(0);
@@ -108,6 +119,26 @@ bool RapidExternalEvtGen::setup() {
 #ifdef RAPID_EVTGEN
 	std::cout << "INFO in RapidExternalEvtGen::setup : Setting decay for external EvtGen generator." << std::endl;
 	if(!evtGen_) setupGenerator();
+
+	//the modes of a cocktail add their decays to those of the job
+	if(evtGen_==sharedEvtGen_ && newJob_) {
+		//user decays replace only the decays they list so those of earlier jobs are first removed
+		TString resetName = decFileName_(0, decFileName_.Length()-4) + "_reset.DEC";
+		std::ofstream fout;
+		fout.open(resetName, std::ofstream::out);
+		for(unsigned int i=0; i<sharedDecayNames_.size(); ++i) {
+			if(std::find(decayNames_.begin(), decayNames_.end(), sharedDecayNames_[i])!=decayNames_.end()) continue;
+			fout << "Decay " << sharedDecayNames_[i] << "\nEnddecay" << std::endl;
+		}
+		fout << "End\n" << std::endl;
+		fout.close();
+		evtGen_->readUDecay(resetName.Data());
+		gSystem->Unlink(resetName);
+		sharedDecayNames_.clear();
+		newJob_ = false;
+	}
+	if(evtGen_==sharedEvtGen_) sharedDecayNames_.insert(sharedDecayNames_.end(), decayNames_.begin(), decayNames_.end());
+
 	evtGen_->readUDecay(decFileName_.Data());
 	return true;
 #else
@@ -116,8 +147,43 @@ bool RapidExternalEvtGen::setup() {
 #endif
 }
 
+void RapidExternalEvtGen::setSeed(unsigned int seed) {
+#ifdef RAPID_EVTGEN
+	//EvtGen draws from a single engine shared by all of its generators
+	std::cout << "INFO in RapidExternalEvtGen::setSeed : setting seed for external EvtGen generator to " << seed << "." << std::endl;
+	installRandomEngine(new EvtMTRandomEngine(seed), false);
+#else
+	(void)seed;
+#endif
+}
+
+#ifdef RAPID_EVTGEN
+void RapidExternalEvtGen::installRandomEngine(EvtRandomEngine* engine, bool installed) {
+	if(!installed) EvtRandom::setRandomEngine(engine);
+	//the previous engine is only deleted once EvtGen has stopped using it
+	if(randomEngine_) delete randomEngine_;
+	randomEngine_ = engine;
+}
+#endif
+
+void RapidExternalEvtGen::startJob() {
+#ifdef RAPID_EVTGEN
+	newJob_ = true;
+#endif
+}
+
 bool RapidExternalEvtGen::setupGenerator() {
 #ifdef RAPID_EVTGEN
+	//initialising EvtGen is expensive so a long-lived process only does it once
+	//each job's DEC file is read as a user decay file once the decays of the previous job have been removed
+	if(sharedEvtGen_ && RapidResourceCache::getInstance()->enabled()) {
+		std::cout << "INFO in RapidExternalEvtGen::setupGenerator : Reusing external EvtGen generator." << std::endl;
+		evtGen_ = sharedEvtGen_;
+		//seeded as a new generator would be so that each job gets its own random numbers
+		if(newJob_) setSeed(gRandom->GetSeed());
+		return true;
+	}
+
 	std::cout << "INFO in RapidExternalEvtGen::setupGenerator : Setting up external EvtGen generator." << std::endl;
 	EvtRandomEngine* randomEngine = 0;
 	EvtAbsRadCorr* radCorrEngine = 0;
@@ -154,6 +220,9 @@ bool RapidExternalEvtGen::setupGenerator() {
 
 	evtGen_ = new EvtGen(decPath.Data(), evtPDLPath.Data(), randomEngine,
 			radCorrEngine, &extraModels);
+	//EvtGen installs the engine itself
+	installRandomEngine(randomEngine, true);
+	if(RapidResourceCache::getInstance()->enabled()) sharedEvtGen_ = evtGen_;
 
 	return true;
 #else
@@ -179,10 +248,12 @@ void RapidExternalEvtGen::writeDecFile(TString fname, std::vector<RapidParticle*
 	}
 
 	// Loop over all particles and write out Decay rule for each
+	decayNames_.clear();
 	for(unsigned int iPart=0; iPart<parts.size(); ++iPart) {
 		unsigned int nChildren = parts[iPart]->nDaughters();
 		if(nChildren>0) {
 			int id = parts[iPart]->id();
+			decayNames_.push_back(getEvtGenName(id));
 			fout << "Decay " << getEvtGenName(id) << "\n1.00\t";
 			if ( !(parts[iPart]->evtGenDecayModel()).Contains("TAUOLA") ) {
 				for(unsigned int iChild=0; iChild<nChildren; ++iChild) {
@@ -193,7 +264,10 @@ void RapidExternalEvtGen::writeDecFile(TString fname, std::vector<RapidParticle*
 			fout <<"Enddecay" << std::endl;
 
 			// Workaround to deal with mixing of B0 and Bs
-			if(TMath::Abs(id)==531||TMath::Abs(id)==511) fout <<"CDecay " << getEvtGenConjName(id) << std::endl << std::endl;
+			if(TMath::Abs(id)==531||TMath::Abs(id)==511) {
+				decayNames_.push_back(getEvtGenConjName(id));
+				fout <<"CDecay " << getEvtGenConjName(id) << std::endl << std::endl;
+			}
 		}
 	}
 	fout <<"End\n" << std::endl;
@@ -1,12 +1,15 @@
 #ifndef RAPIDEXTERNALEVTGEN_H
 #define RAPIDEXTERNALEVTGEN_H
 
+#include <vector>
+
 #include "TString.h"
 
 #include "RapidExternalGenerator.h"
 
 #ifdef RAPID_EVTGEN
 class EvtGen;
+class EvtRandomEngine;
 #endif
 
 class RapidExternalEvtGen : public RapidExternalGenerator {
@@ -20,20 +23,37 @@ class RapidExternalEvtGen : public RapidExternalGenerator {
 			{}
 		virtual bool decay(std::vector<RapidParticle*>& parts);
 		virtual bool setup();
+		virtual void setSeed(unsigned int seed);
 
 		bool setupGenerator();
 		void writeDecFile(TString fname, std::vector<RapidParticle*>& parts, bool usePhotos);
 
+		//start a new job of a long-lived process - when the shared generator is next set up it is reseeded and the
+		//decays of earlier jobs are removed
+		static void startJob();
+
 		static TString getEvtGenName(int id);
 		static TString getEvtGenConjName(int id);
 
 	private:
 #ifdef RAPID_EVTGEN
 		EvtGen* evtGen_;
+
+		//generator kept for all of the jobs of a long-lived process
+		static EvtGen* sharedEvtGen_;
+		//particles given a user decay by the current job of the shared generator
+		static std::vector<TString> sharedDecayNames_;
+		static bool newJob_;
+
+		//random number engine installed in EvtGen, which does not delete the engines it is given
+		static EvtRandomEngine* randomEngine_;
+		static void installRandomEngine(EvtRandomEngine* engine, bool installed);
 #else
 		bool suppressWarning_;
 #endif
 		TString decFileName_;
+		//particles given a decay in the DEC file
+		std::vector<TString> decayNames_;
 };
 
 #endif
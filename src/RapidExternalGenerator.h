@@ -11,6 +11,9 @@ class RapidExternalGenerator {
 
 		virtual bool decay(std::vector<RapidParticle*>& /*parts*/)=0;
 		virtual bool setup()=0;
+
+		//reseed any random number generator of its own
+		virtual void setSeed(unsigned int /*seed*/) {}
 };
 
 #endif
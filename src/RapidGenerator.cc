@@ -0,0 +1,107 @@
+#include "RapidGenerator.h"
+
+#include <iostream>
+
+#include "RapidAcceptance.h"
+#include "RapidConfig.h"
+#include "RapidDecay.h"
+#include "RapidHistWriter.h"
+
+RapidGenerator::~RapidGenerator() {
+	//the decay, acceptance and writer belong to the configuration
+	if(config_) delete config_;
+}
+
+bool RapidGenerator::load(TString mode) {
+	if(config_) delete config_;
+	config_ = new RapidConfig();
+	for(unsigned int i=0; i<settings_.size(); ++i) {
+		config_->addOverride(settings_[i]);
+	}
+
+	return setup(config_->load(mode));
+}
+
+bool RapidGenerator::load(TString name, TString decay, TString config) {
+	if(config_) delete config_;
+	config_ = new RapidConfig();
+	for(unsigned int i=0; i<settings_.size(); ++i) {
+		config_->addOverride(settings_[i]);
+	}
+
+	return setup(config_->load(name, decay, config));
+}
+
+bool RapidGenerator::setup(bool loaded) {
+	decay_ = 0;
+	acceptance_ = 0;
+	writer_ = 0;
+	columns_.clear();
+	nParents_ = 0;
+	nGenerated_ = 0;
+	nSelected_ = 0;
+
+	if(!loaded) {
+		std::cout << "ERROR in RapidGenerator::setup : failed to load configuration." << std::endl;
+		return false;
+	}
+
+	decay_ = config_->getDecay();
+	if(!decay_) {
+		std::cout << "ERROR in RapidGenerator::setup : failed to setup decay." << std::endl;
+		return false;
+	}
+
+	acceptance_ = config_->getAcceptance();
+
+	//the writer evaluates the parameters - without a tree nothing is written until the histograms are saved
+	writer_ = config_->getWriter(false);
+	writer_->getNames(columns_);
+
+	return true;
+}
+
+int RapidGenerator::generate(int nParents, RapidEventBatch& batch) {
+	if(batch.names()!=columns_) batch.setColumns(columns_);
+	return run(nParents, &batch, 0);
+}
+
+int RapidGenerator::generate(int nParents, EventCallback callback) {
+	return run(nParents, 0, &callback);
+}
+
+void RapidGenerator::saveHistograms() {
+	if(writer_) writer_->save();
+}
+
+int RapidGenerator::run(int nParents, RapidEventBatch* batch, const EventCallback* callback) {
+	if(!decay_) {
+		std::cout << "WARNING in RapidGenerator::generate : no decay has been loaded." << std::endl;
+		return 0;
+	}
+
+	int nSelectedBefore = nSelected_;
+
+	for(int n=0; n<nParents; ++n) {
+		writer_->setNEvent(nParents_++);
+		if(!decay_->generate()) continue;
+		++nGenerated_;
+		if(acceptance_->isSelected()) select(batch, callback);
+
+		for(int nrd=0; nrd<nToReDecay_; ++nrd) {
+			if(!decay_->generate(false)) continue;
+			++nGenerated_;
+			if(acceptance_->isSelected()) select(batch, callback);
+		}
+	}
+
+	return nSelected_ - nSelectedBefore;
+}
+
+void RapidGenerator::select(RapidEventBatch* batch, const EventCallback* callback) {
+	++nSelected_;
+	writer_->fill();
+
+	if(batch) batch->addEvent(writer_->values());
+	if(callback) (*callback)(writer_->values());
+}
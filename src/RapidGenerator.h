@@ -0,0 +1,82 @@
+#ifndef RAPIDGENERATOR_H
+#define RAPIDGENERATOR_H
+
+#include <functional>
+#include <vector>
+
+#include "TString.h"
+
+#include "RapidEventBatch.h"
+
+class RapidAcceptance;
+class RapidConfig;
+class RapidDecay;
+class RapidHistWriter;
+
+//generates events in-process and hands them to the caller rather than writing them to files
+//
+//each generator owns its configuration, particle data and beam conditions so several may be used at once
+//the ROOT random number generator, gRandom, is shared between them
+class RapidGenerator {
+	public:
+		//called with the values of each selected event in the order of columns()
+		typedef std::function<void(const std::vector<double>& values)> EventCallback;
+
+		RapidGenerator()
+			: config_(0), decay_(0), acceptance_(0), writer_(0),
+			  nToReDecay_(0), nParents_(0), nGenerated_(0), nSelected_(0)
+			{}
+
+		~RapidGenerator();
+
+		//a line in the format of the config file applied after it has been read - must be given before loading
+		void addSetting(TString line) { settings_.push_back(line); }
+
+		//set up from <mode>.decay and <mode>.config
+		bool load(TString mode);
+		//set up from the contents of a .decay and a .config file - name is only used for any output
+		bool load(TString name, TString decay, TString config);
+
+		//number of times each parent is re-decayed
+		void setReDecay(int nToReDecay) { nToReDecay_ = nToReDecay; }
+
+		//names of the values given for each event, as the histograms and tree branches written by RapidSim.exe
+		const std::vector<TString>& columns() { return columns_; }
+
+		//generate this many parents and add the selected events to the batch or pass them to the callback
+		//returns the number of events selected
+		int generate(int nParents, RapidEventBatch& batch);
+		int generate(int nParents, EventCallback callback);
+
+		//write histograms of the events selected so far to <name>_hists.root
+		void saveHistograms();
+
+		int nParents() { return nParents_; }
+		int nGenerated() { return nGenerated_; }
+		int nSelected() { return nSelected_; }
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidGenerator( const RapidGenerator& other );
+		RapidGenerator& operator=( const RapidGenerator& other );
+
+		bool setup(bool loaded);
+		int run(int nParents, RapidEventBatch* batch, const EventCallback* callback);
+		void select(RapidEventBatch* batch, const EventCallback* callback);
+
+		std::vector<TString> settings_;
+
+		RapidConfig* config_;
+		RapidDecay* decay_;
+		RapidAcceptance* acceptance_;
+		RapidHistWriter* writer_;
+
+		std::vector<TString> columns_;
+
+		int nToReDecay_;
+		int nParents_;
+		int nGenerated_;
+		int nSelected_;
+};
+
+#endif
@@ -1,7 +1,19 @@
 #include "RapidHistWriter.h"
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "TBranch.h"
+#include "TObjString.h"
+#include "TSystem.h"
+
+#include "RapidCheckpoint.h"
+#include "RapidMemory.h"
 #include "RapidParam.h"
 #include "RapidParticle.h"
+#include "RapidSmearVariations.h"
+#include "RapidWeights.h"
 
 RapidHistWriter::~RapidHistWriter() {
 	if(tree_) {
@@ -12,6 +24,14 @@ RapidHistWriter::~RapidHistWriter() {
 		delete histos_[histos_.size()-1];
 		histos_.pop_back();
 	}
+	while(!weightedHistos_.empty()) {
+		delete weightedHistos_[weightedHistos_.size()-1];
+		weightedHistos_.pop_back();
+	}
+	while(!variationHistos_.empty()) {
+		delete variationHistos_[variationHistos_.size()-1];
+		variationHistos_.pop_back();
+	}
 }
 
 void RapidHistWriter::setup(bool saveTree) {
@@ -25,6 +45,8 @@ void RapidHistWriter::setup(bool saveTree) {
 	}
 
 	setupHistos();
+	if(weights_) setupWeightedHistos();
+	if(variations_) setupVariations();
 	if(saveTree) setupTree(); //called after setupHistos so we know the number of parameters
 }
 
@@ -93,21 +115,167 @@ void RapidHistWriter::fill() {
 		}
 	}
 
-	if(tree_) tree_->Fill();
+	if(weights_) {
+		weights_->calculate();
+		unsigned int nHistos = histos_.size();
+		for(unsigned int w=0; w<weights_->nVariations(); ++w) {
+			double weight = weights_->weight(w);
+			for(unsigned int i=0; i<nHistos; ++i) {
+				weightedHistos_[w*nHistos+i]->Fill(vars_[i], weight);
+			}
+		}
+	}
+
+	if(variations_) fillVariations();
+
+	if(tree_) {
+		treeTimer_.Start(kFALSE);
+		if(treeSettings_.rollover() && treeFileFull()) rollTreeFile();
+		if(tree_->GetEntries()==0) firstEventInFile_ = nevent_;
+		lastEventInFile_ = nevent_;
+		tree_->Fill();
+		treeTimer_.Stop();
+	}
+}
+
+Long64_t RapidHistWriter::histogramBytes() {
+	std::vector<TH1F*> histos;
+	getHistograms(histos);
+
+	Long64_t bytes(0);
+	for(unsigned int i=0; i<histos.size(); ++i) {
+		bytes += RapidMemory::histBytes(histos[i]);
+	}
+	return bytes;
+}
+
+Long64_t RapidHistWriter::basketBytes() {
+	if(!tree_) return 0;
+
+	//each branch holds the basket being filled and typically one more being compressed
+	Long64_t bytes(0);
+	TIter next(tree_->GetListOfBranches());
+	while(TBranch* branch = dynamic_cast<TBranch*>(next())) {
+		bytes += 2*branch->GetBasketSize();
+	}
+	return bytes;
 }
 
 void RapidHistWriter::save() {
 	std::cout << "INFO in RapidHistWriter::save : saving histograms to file: " << name_ << "_hists.root" << std::endl;
 	TFile* histFile = new TFile(name_+"_hists.root", "RECREATE");
 
-	for(unsigned int i=0; i<histos_.size(); ++i) {
-		histos_[i]->Write();
+	std::vector<TH1F*> histos;
+	getHistograms(histos);
+	for(unsigned int i=0; i<histos.size(); ++i) {
+		histos[i]->Write();
 	}
 	histFile->Close();
 
 	if(tree_) {
+		treeTimer_.Start(kFALSE);
 		tree_->AutoSave();
+		treeTimer_.Stop();
+		if(treeSettings_.rollover()) writeIndex(true);
+		printTreeReport();
+	}
+}
+
+void RapidHistWriter::saveHistograms(TDirectory* dir) {
+	std::vector<TH1F*> histos;
+	getHistograms(histos);
+	for(unsigned int i=0; i<histos.size(); ++i) {
+		dir->WriteTObject(histos[i]);
+	}
+}
+
+void RapidHistWriter::writeCheckpoint(TDirectory* dir) {
+	std::vector<TH1F*> histos;
+	getHistograms(histos);
+	for(unsigned int i=0; i<histos.size(); ++i) {
+		dir->WriteTObject(histos[i]);
+	}
+
+	RapidCheckpoint::writeValue(dir, "saveTree", tree_!=0);
+	if(!tree_) return;
+
+	//flush the baskets and tree header so the file is readable up to this entry
+	treeTimer_.Start(kFALSE);
+	tree_->AutoSave("FlushBaskets SaveSelf");
+	treeTimer_.Stop();
+	if(treeSettings_.rollover()) writeIndex(true);
+
+	RapidCheckpoint::writeValue(dir, "treeFileIndex", treeFileIndex_);
+	RapidCheckpoint::writeValue(dir, "treeEntries", tree_->GetEntries());
+	RapidCheckpoint::writeValue(dir, "firstEventInFile", firstEventInFile_);
+	RapidCheckpoint::writeValue(dir, "lastEventInFile", lastEventInFile_);
+	RapidCheckpoint::writeValue(dir, "closedEntries", closedEntries_);
+	RapidCheckpoint::writeValue(dir, "closedTotBytes", closedTotBytes_);
+	RapidCheckpoint::writeValue(dir, "closedZipBytes", closedZipBytes_);
+
+	std::ostringstream index;
+	for(unsigned int i=0; i<indexFileNames_.size(); ++i) {
+		index << indexFileNames_[i] << " " << indexFirstEvents_[i] << " " << indexLastEvents_[i] << " " << indexEntries_[i] << "\n";
+	}
+	TObjString indexStr(index.str().c_str());
+	dir->WriteTObject(&indexStr, "index");
+}
+
+bool RapidHistWriter::restore(TDirectory* dir) {
+	std::vector<TH1F*> histos;
+	getHistograms(histos);
+	for(unsigned int i=0; i<histos.size(); ++i) {
+		TH1* hist(0);
+		dir->GetObject(histos[i]->GetName(), hist);
+		if(!hist) {
+			std::cout << "ERROR in RapidHistWriter::restore : histogram " << histos[i]->GetName() << " not found in checkpoint." << std::endl;
+			return false;
+		}
+		histos[i]->Add(hist);
+		delete hist;
 	}
+
+	Long64_t value(0);
+	if(!RapidCheckpoint::readValue(dir, "saveTree", value)) return false;
+	if(!value) return true;
+
+	Long64_t nEntries(0);
+	if(!RapidCheckpoint::readValue(dir, "treeFileIndex", value)) return false;
+	treeFileIndex_ = value;
+	if(!RapidCheckpoint::readValue(dir, "treeEntries", nEntries)) return false;
+	if(!RapidCheckpoint::readValue(dir, "firstEventInFile", value)) return false;
+	firstEventInFile_ = value;
+	if(!RapidCheckpoint::readValue(dir, "lastEventInFile", value)) return false;
+	lastEventInFile_ = value;
+	if(!RapidCheckpoint::readValue(dir, "closedEntries", closedEntries_)) return false;
+	if(!RapidCheckpoint::readValue(dir, "closedTotBytes", closedTotBytes_)) return false;
+	if(!RapidCheckpoint::readValue(dir, "closedZipBytes", closedZipBytes_)) return false;
+
+	TObjString* indexStr(0);
+	dir->GetObject("index", indexStr);
+	if(!indexStr) {
+		std::cout << "ERROR in RapidHistWriter::restore : file index not found in checkpoint." << std::endl;
+		return false;
+	}
+	std::istringstream index(indexStr->GetString().Data());
+	std::string fileName;
+	int first(0), last(0);
+	Long64_t entries(0);
+	while(index >> fileName >> first >> last >> entries) {
+		indexFileNames_.push_back(fileName);
+		indexFirstEvents_.push_back(first);
+		indexLastEvents_.push_back(last);
+		indexEntries_.push_back(entries);
+	}
+	delete indexStr;
+
+	std::cout << "INFO in RapidHistWriter::restore : tree will be appended to file: " << treeFileName() << std::endl;
+
+	if(!reopenTreeFile(nEntries)) return false;
+	if(treeSettings_.rollover()) writeIndex(false);
+
+	treeTimer_.Reset();
+	return true;
 }
 
 void RapidHistWriter::setupHistos() {
@@ -182,9 +350,73 @@ void RapidHistWriter::setupHistos() {
 		}
 	}
 
+	//the histograms belong to the writer rather than the current directory so several writers may exist at once
+	for(unsigned int i=0; i<histos_.size(); ++i) {
+		histos_[i]->SetDirectory(0);
+	}
+
 	vars_ = std::vector<double>(histos_.size(), 0);
 }
 
+void RapidHistWriter::setupWeightedHistos() {
+	for(unsigned int w=0; w<weights_->nVariations(); ++w) {
+		for(unsigned int i=0; i<histos_.size(); ++i) {
+			TH1F* hist = dynamic_cast<TH1F*>(histos_[i]->Clone(histos_[i]->GetName()+TString("_w_")+weights_->name(w)));
+			hist->SetDirectory(0);
+			hist->Sumw2();
+			weightedHistos_.push_back(hist);
+		}
+	}
+}
+
+void RapidHistWriter::setupVariations() {
+	//only the default hypothesis is re-evaluated - it is the first set of histograms
+	std::vector<RapidParam*> params;
+	params.insert(params.end(), paramsDecaying_.begin(), paramsDecaying_.end());
+	params.insert(params.end(), paramsStable_.begin(), paramsStable_.end());
+	params.insert(params.end(), paramsTwoBody_.begin(), paramsTwoBody_.end());
+	params.insert(params.end(), paramsThreeBody_.begin(), paramsThreeBody_.end());
+	params.insert(params.end(), params_.begin(), params_.end());
+
+	std::vector<unsigned int> columns;
+	for(unsigned int i=0; i<params.size(); ++i) {
+		if(params[i]->truth() || !params[i]->canBeSmeared()) continue;
+		smearedParams_.push_back(params[i]);
+		columns.push_back(i);
+	}
+
+	for(unsigned int v=0; v<variations_->nVariations(); ++v) {
+		for(unsigned int i=0; i<columns.size(); ++i) {
+			TH1F* hist = dynamic_cast<TH1F*>(histos_[columns[i]]->Clone(histos_[columns[i]]->GetName()+TString("_")+variations_->name(v)));
+			hist->SetDirectory(0);
+			variationHistos_.push_back(hist);
+		}
+	}
+
+	variationVars_ = std::vector<double>(variationHistos_.size(), 0);
+}
+
+void RapidHistWriter::enableTruthEvent() {
+	if(writeTruthEvent_) return;
+	writeTruthEvent_ = true;
+
+	//the tree may already have been set up
+	if(tree_) tree_->Branch("nTruthEvent",&truthEvent_,"nTruthEvent/L",treeSettings_.basketSize());
+}
+
+void RapidHistWriter::getHistograms(std::vector<TH1F*>& histos) {
+	histos = histos_;
+	histos.insert(histos.end(), weightedHistos_.begin(), weightedHistos_.end());
+	histos.insert(histos.end(), variationHistos_.begin(), variationHistos_.end());
+}
+
+void RapidHistWriter::getNames(std::vector<TString>& names) {
+	names.clear();
+	for(unsigned int i=0; i<histos_.size(); ++i) {
+		names.push_back(histos_[i]->GetName());
+	}
+}
+
 
 void RapidHistWriter::setupSingleHypothesis(TString suffix) {
 	std::vector<RapidParam*>::iterator itParam;
@@ -231,18 +463,38 @@ void RapidHistWriter::setupSingleHypothesis(TString suffix) {
 }
 
 void RapidHistWriter::setupTree() {
-	std::cout << "INFO in RapidHistWriter::setupTree : tree will be saved to file: " << name_ << "_tree.root" << std::endl;
+	std::cout << "INFO in RapidHistWriter::setupTree : tree will be saved to file: " << treeFileName() << std::endl;
 	std::cout << "                                     This will slow down generation." << std::endl;
 
-	treeFile_ = new TFile(name_+"_tree.root", "RECREATE");
-	tree_ = new TTree("DecayTree","DecayTree");
-	tree_->SetDirectory(treeFile_);
-
-	tree_->Branch("nEvent",&nevent_);
-	for(unsigned int i=0; i<histos_.size(); ++i) {
-		tree_->Branch(histos_[i]->GetName(), &vars_[i]);
+	if(treeSettings_.rollover()) {
+		std::cout << "INFO in RapidHistWriter::setupTree : tree will roll over to a new file when the size or number of events limit is reached." << std::endl
+			  << "                                     an index of the files will be written to: " << name_ << "_tree_index.txt" << std::endl;
+		treeFileIndex_ = 1;
 	}
 
+	openTreeFile();
+
+	treeTimer_.Reset();
+}
+
+void RapidHistWriter::printTreeReport() {
+	Long64_t nEntries = closedEntries_ + tree_->GetEntries();
+	double totMB = (closedTotBytes_ + tree_->GetTotBytes())/1.e6;
+	double zipMB = (closedZipBytes_ + tree_->GetZipBytes())/1.e6;
+	double time  = treeTimer_.RealTime();
+
+	std::cout << "INFO in RapidHistWriter::printTreeReport : " << nEntries << " entries written to " << indexFileNames_.size()+1 << " file(s)" << std::endl
+		  << "                                           uncompressed size : " << totMB << " MB" << std::endl
+		  << "                                           compressed size   : " << zipMB << " MB" << std::endl;
+	if(zipMB>0.) {
+		std::cout << "                                           compression factor: " << totMB/zipMB << std::endl;
+	}
+	if(nEntries>0) {
+		std::cout << "                                           bytes per event   : " << 1.e6*zipMB/nEntries << std::endl;
+	}
+	if(time>0.) {
+		std::cout << "                                           output rate       : " << zipMB/time << " MB/s (" << totMB/time << " MB/s uncompressed)" << std::endl;
+	}
 }
 
 unsigned int RapidHistWriter::fillSingleHypothesis(unsigned int offset) {
@@ -288,3 +540,188 @@ unsigned int RapidHistWriter::fillSingleHypothesis(unsigned int offset) {
 
 	return offset;
 }
+
+void RapidHistWriter::fillVariations() {
+	unsigned int nParams = smearedParams_.size();
+
+	variations_->save();
+	for(unsigned int v=0; v<variations_->nVariations(); ++v) {
+		if(!variations_->apply(v)) break;
+		for(unsigned int i=0; i<nParams; ++i) {
+			unsigned int index = v*nParams+i;
+			variationVars_[index] = smearedParams_[i]->eval();
+			variationHistos_[index]->Fill(variationVars_[index]);
+		}
+	}
+	variations_->restore();
+}
+
+TString RapidHistWriter::treeFileName() {
+	if(treeFileIndex_==0) return name_+"_tree.root";
+
+	return TString::Format("%s_tree_%04d.root", name_.Data(), treeFileIndex_);
+}
+
+void RapidHistWriter::openTreeFile() {
+	treeFile_ = new TFile(treeFileName(), "RECREATE");
+	if(treeSettings_.compression()>=0) {
+		std::cout << "INFO in RapidHistWriter::openTreeFile : setting compression to " << treeSettings_.compression() << "." << std::endl;
+		treeFile_->SetCompressionSettings(treeSettings_.compression());
+	}
+
+	tree_ = new TTree("DecayTree","DecayTree");
+	tree_->SetDirectory(treeFile_);
+	flushedEnd_ = 0;
+	flushedTotBytes_ = 0;
+
+	//with a size limit the baskets are flushed at least every tenth of the limit so that little is held back from the file
+	Long64_t autoFlush = treeSettings_.autoFlush();
+	if(treeSettings_.maxFileSize()>0 && autoFlush<=0) {
+		//the ROOT default is 30 MB
+		if(autoFlush==0) autoFlush = -30000000;
+		if(autoFlush < -treeSettings_.maxFileSize()/10) autoFlush = -treeSettings_.maxFileSize()/10;
+	}
+	if(autoFlush!=0) {
+		tree_->SetAutoFlush(autoFlush);
+	}
+
+	int basketSize = treeSettings_.basketSize();
+	tree_->Branch("nEvent",&nevent_,"nEvent/I",basketSize);
+	if(writeTruthEvent_) tree_->Branch("nTruthEvent",&truthEvent_,"nTruthEvent/L",basketSize);
+	for(unsigned int i=0; i<histos_.size(); ++i) {
+		TString varName = histos_[i]->GetName();
+		tree_->Branch(varName, &vars_[i], treeSettings_.leafList(varName), basketSize);
+	}
+	if(weights_) {
+		const std::vector<double>& weights = weights_->values();
+		for(unsigned int i=0; i<weights.size(); ++i) {
+			TString varName = "w_" + weights_->name(i);
+			tree_->Branch(varName, const_cast<double*>(&weights[i]), treeSettings_.leafList(varName), basketSize);
+		}
+	}
+	for(unsigned int i=0; i<variationHistos_.size(); ++i) {
+		TString varName = variationHistos_[i]->GetName();
+		tree_->Branch(varName, &variationVars_[i], treeSettings_.leafList(varName), basketSize);
+	}
+}
+
+bool RapidHistWriter::reopenTreeFile(Long64_t nEntries) {
+	TString fileName = treeFileName();
+
+	TFile* file = TFile::Open(fileName, "READ");
+	TTree* tree(0);
+	if(file && !file->IsZombie()) file->GetObject("DecayTree", tree);
+	if(!tree || tree->GetEntries()<nEntries) {
+		std::cout << "ERROR in RapidHistWriter::reopenTreeFile : file " << fileName << " does not contain the " << nEntries << " entries written before the checkpoint." << std::endl;
+		if(file) delete file;
+		return false;
+	}
+
+	//entries filled after the checkpoint may have been flushed before the job stopped - these are removed
+	if(tree->GetEntries()>nEntries) {
+		std::cout << "INFO in RapidHistWriter::reopenTreeFile : discarding " << tree->GetEntries()-nEntries << " entries written after the checkpoint." << std::endl;
+		TFile* copyFile = new TFile(fileName+".tmp", "RECREATE");
+		copyFile->SetCompressionSettings(file->GetCompressionSettings());
+		TTree* copy = tree->CopyTree("", "", nEntries);
+		copy->AutoSave();
+		copyFile->Close();
+		delete copyFile;
+		file->Close();
+		delete file;
+		if(gSystem->Rename(fileName+".tmp", fileName)!=0) {
+			std::cout << "ERROR in RapidHistWriter::reopenTreeFile : failed to replace " << fileName << "." << std::endl;
+			return false;
+		}
+	} else {
+		file->Close();
+		delete file;
+	}
+
+	treeFile_ = new TFile(fileName, "UPDATE");
+	treeFile_->GetObject("DecayTree", tree_);
+	flushedEnd_ = 0;
+	flushedTotBytes_ = 0;
+	if(!tree_) {
+		std::cout << "ERROR in RapidHistWriter::reopenTreeFile : failed to reopen tree in file " << fileName << "." << std::endl;
+		return false;
+	}
+
+	tree_->SetBranchAddress("nEvent", &nevent_);
+	if(writeTruthEvent_) tree_->SetBranchAddress("nTruthEvent", &truthEvent_);
+	for(unsigned int i=0; i<histos_.size(); ++i) {
+		tree_->SetBranchAddress(histos_[i]->GetName(), &vars_[i]);
+	}
+	if(weights_) {
+		const std::vector<double>& weights = weights_->values();
+		for(unsigned int i=0; i<weights.size(); ++i) {
+			tree_->SetBranchAddress("w_" + weights_->name(i), const_cast<double*>(&weights[i]));
+		}
+	}
+	for(unsigned int i=0; i<variationHistos_.size(); ++i) {
+		tree_->SetBranchAddress(variationHistos_[i]->GetName(), &variationVars_[i]);
+	}
+
+	return true;
+}
+
+void RapidHistWriter::closeTreeFile() {
+	tree_->AutoSave();
+
+	closedEntries_  += tree_->GetEntries();
+	closedTotBytes_ += tree_->GetTotBytes();
+	closedZipBytes_ += tree_->GetZipBytes();
+
+	//closing the file also deletes the tree
+	treeFile_->Close();
+	delete treeFile_;
+	treeFile_ = 0;
+	tree_ = 0;
+}
+
+bool RapidHistWriter::treeFileFull() {
+	if(treeSettings_.maxFileEntries()>0 && tree_->GetEntries()>=treeSettings_.maxFileEntries()) return true;
+	if(treeSettings_.maxFileSize()<=0) return false;
+
+	//the file only grows when baskets are flushed so the entries filled since are added at the compression seen so far
+	Long64_t end = treeFile_->GetEND();
+	Long64_t totBytes = tree_->GetTotBytes();
+	if(end!=flushedEnd_) {
+		flushedEnd_ = end;
+		flushedTotBytes_ = totBytes;
+	}
+	double compression = flushedTotBytes_>0 ? static_cast<double>(tree_->GetZipBytes())/flushedTotBytes_ : 1.;
+	return end + compression*(totBytes-flushedTotBytes_) >= treeSettings_.maxFileSize();
+}
+
+void RapidHistWriter::rollTreeFile() {
+	indexFileNames_.push_back(gSystem->BaseName(treeFileName()));
+	indexFirstEvents_.push_back(firstEventInFile_);
+	indexLastEvents_.push_back(lastEventInFile_);
+	indexEntries_.push_back(tree_->GetEntries());
+
+	closeTreeFile();
+	++treeFileIndex_;
+	std::cout << "INFO in RapidHistWriter::rollTreeFile : rolling over to new file: " << treeFileName() << std::endl;
+	openTreeFile();
+
+	//keep the index up to date so that the closed files can be used if the job stops early
+	writeIndex(false);
+}
+
+void RapidHistWriter::writeIndex(bool includeCurrent) {
+	TString indexName = name_+"_tree_index.txt";
+
+	//write to a temporary file and move it into place so the index is never partially written
+	std::ofstream fout;
+	fout.open(indexName+".tmp", std::ofstream::out);
+	fout << "# file\tfirstEvent\tlastEvent\tnEntries\n";
+	for(unsigned int i=0; i<indexFileNames_.size(); ++i) {
+		fout << indexFileNames_[i] << "\t" << indexFirstEvents_[i] << "\t" << indexLastEvents_[i] << "\t" << indexEntries_[i] << "\n";
+	}
+	if(includeCurrent && tree_->GetEntries()>0) {
+		fout << gSystem->BaseName(treeFileName()) << "\t" << firstEventInFile_ << "\t" << lastEventInFile_ << "\t" << tree_->GetEntries() << "\n";
+	}
+	fout.close();
+
+	std::rename(indexName+".tmp", indexName);
+}
@@ -3,35 +3,75 @@
 
 #include <vector>
 
+#include "TDirectory.h"
 #include "TFile.h"
 #include "TH1F.h"
+#include "TStopwatch.h"
 #include "TString.h"
 #include "TTree.h"
 
+#include "RapidTreeSettings.h"
+
 class RapidParam;
 class RapidParticle;
+class RapidSmearVariations;
+class RapidWeights;
 
 class RapidHistWriter {
 	public:
-		RapidHistWriter(const std::vector<RapidParticle*>& parts, const std::vector<RapidParam*>& params, const std::vector<RapidParam*>& paramsStable, const std::vector<RapidParam*>& paramsDecaying, const std::vector<RapidParam*>& paramsTwoBody, const std::vector<RapidParam*>& paramsThreeBody, TString name, bool saveTree)
-			: name_(name), parts_(parts), params_(params), paramsStable_(paramsStable), paramsDecaying_(paramsDecaying), paramsTwoBody_(paramsTwoBody), paramsThreeBody_(paramsThreeBody), treeFile_(0), tree_(0)
+		RapidHistWriter(const std::vector<RapidParticle*>& parts, const std::vector<RapidParam*>& params, const std::vector<RapidParam*>& paramsStable, const std::vector<RapidParam*>& paramsDecaying, const std::vector<RapidParam*>& paramsTwoBody, const std::vector<RapidParam*>& paramsThreeBody, TString name, bool saveTree, const RapidTreeSettings& treeSettings=RapidTreeSettings(), RapidWeights* weights=0, RapidSmearVariations* variations=0)
+			: name_(name), parts_(parts), params_(params), paramsStable_(paramsStable), paramsDecaying_(paramsDecaying), paramsTwoBody_(paramsTwoBody), paramsThreeBody_(paramsThreeBody), weights_(weights), variations_(variations), treeSettings_(treeSettings), treeFile_(0), tree_(0), nevent_(0), writeTruthEvent_(false), truthEvent_(0),
+			  treeFileIndex_(0), firstEventInFile_(0), lastEventInFile_(0),
+			  flushedEnd_(0), flushedTotBytes_(0),
+			  closedEntries_(0), closedTotBytes_(0), closedZipBytes_(0)
 		{setup(saveTree);}
 
 		~RapidHistWriter();
 
 		void fill();
 		void save();
+		//write the histograms to a directory rather than to <name>_hists.root
+		void saveHistograms(TDirectory* dir);
+
+		void writeCheckpoint(TDirectory* dir);
+		bool restore(TDirectory* dir);
 
 		void setNEvent(int nevent) { nevent_ = nevent; }
+		//add a branch identifying the true decay of each event, for events that share one
+		void enableTruthEvent();
+		void setTruthEvent(Long64_t truthEvent) { truthEvent_ = truthEvent; }
+
+		//values of the last event filled and their names, in the order of the histograms and branches
+		const std::vector<double>& values() { return vars_; }
+		void getNames(std::vector<TString>& names);
+
+		//memory held by the histograms and an estimate of that held by the tree baskets
+		Long64_t histogramBytes();
+		Long64_t basketBytes();
 
 	private:
 		void setup(bool saveTree);
 
 		void setupHistos();
 		void setupSingleHypothesis(TString suffix="");
+		void setupWeightedHistos();
+		void setupVariations();
 		void setupTree();
+		void printTreeReport();
+
+		TString treeFileName();
+		void openTreeFile();
+		bool reopenTreeFile(Long64_t nEntries);
+		void closeTreeFile();
+		bool treeFileFull();
+		void rollTreeFile();
+		void writeIndex(bool includeCurrent);
 
 		unsigned int fillSingleHypothesis(unsigned int offset=0);
+		void fillVariations();
+
+		//the histograms of the parameters followed by any weighted or varied copies
+		void getHistograms(std::vector<TH1F*>& histos);
 
 		TString name_;
 
@@ -52,11 +92,50 @@ class RapidHistWriter {
 		//histograms to store parameters in
 		std::vector<TH1F*> histos_;
 
+		//weights for alternative settings and a copy of every histogram filled with each weight
+		RapidWeights* weights_;
+		std::vector<TH1F*> weightedHistos_;
+
+		//smearing variations, the parameters of the default hypothesis that depend on the smearing and their values
+		//and histograms in each variation
+		RapidSmearVariations* variations_;
+		std::vector<RapidParam*> smearedParams_;
+		std::vector<double> variationVars_;
+		std::vector<TH1F*> variationHistos_;
+
+		//output layout of the tree
+		RapidTreeSettings treeSettings_;
+
 		//tree to store parameters in
 		TFile* treeFile_;
 		TTree* tree_;
 		int nevent_;
+		bool writeTruthEvent_;
+		Long64_t truthEvent_;
 		std::vector<double> vars_;
+
+		//time spent filling and flushing the tree
+		TStopwatch treeTimer_;
+
+		//rolling output files
+		int treeFileIndex_;
+		int firstEventInFile_;
+		int lastEventInFile_;
+
+		//index of the output files that have been closed
+		std::vector<TString> indexFileNames_;
+		std::vector<int> indexFirstEvents_;
+		std::vector<int> indexLastEvents_;
+		std::vector<Long64_t> indexEntries_;
+
+		//end of the current output file when it last grew and the uncompressed bytes filled by then
+		Long64_t flushedEnd_;
+		Long64_t flushedTotBytes_;
+
+		//totals for the output files that have been closed
+		Long64_t closedEntries_;
+		Long64_t closedTotBytes_;
+		Long64_t closedZipBytes_;
 };
 
 #endif
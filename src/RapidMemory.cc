@@ -0,0 +1,91 @@
+#include "RapidMemory.h"
+
+#include <cstdio>
+#include <iostream>
+
+#include "TArrayC.h"
+#include "TArrayD.h"
+#include "TArrayF.h"
+#include "TArrayI.h"
+#include "TArrayS.h"
+#include "TClass.h"
+#include "TSystem.h"
+
+#include "RooArgSet.h"
+#include "RooDataSet.h"
+
+#include "RapidSummary.h"
+
+Long64_t RapidMemory::histBytes(TH1* hist) {
+	if(!hist) return 0;
+
+	//the object itself, the bin contents and the sum of squared weights
+	Long64_t bytes = hist->IsA()->Size();
+	Long64_t nCells = hist->GetNcells();
+	if(dynamic_cast<TArrayD*>(hist)) bytes += nCells*sizeof(Double_t);
+	else if(dynamic_cast<TArrayF*>(hist)) bytes += nCells*sizeof(Float_t);
+	else if(dynamic_cast<TArrayI*>(hist)) bytes += nCells*sizeof(Int_t);
+	else if(dynamic_cast<TArrayS*>(hist)) bytes += nCells*sizeof(Short_t);
+	else if(dynamic_cast<TArrayC*>(hist)) bytes += nCells*sizeof(Char_t);
+	bytes += hist->GetSumw2N()*sizeof(Double_t);
+
+	return bytes;
+}
+
+Long64_t RapidMemory::dataSetBytes(RooDataSet* data) {
+	if(!data || data->numEntries()==0) return 0;
+
+	//values are stored in a vector of doubles for each variable
+	return static_cast<Long64_t>(data->numEntries())*data->get()->getSize()*sizeof(Double_t);
+}
+
+Long64_t RapidMemory::residentBytes() {
+	ProcInfo_t info;
+	if(gSystem->GetProcInfo(&info)!=0) return 0;
+	//given in kB
+	return static_cast<Long64_t>(info.fMemResident)*1024;
+}
+
+void RapidMemory::snapshot(TString label) {
+	labels_.push_back(label);
+	times_.push_back(difftime(time(0), start_));
+	resident_.push_back(residentBytes());
+	subsystems_.push_back(std::vector<TString>());
+	bytes_.push_back(std::vector<Long64_t>());
+}
+
+void RapidMemory::add(TString subsystem, Long64_t bytes) {
+	if(labels_.empty()) snapshot("");
+	subsystems_.back().push_back(subsystem);
+	bytes_.back().push_back(bytes);
+}
+
+void RapidMemory::print() {
+	if(labels_.empty()) return;
+
+	std::cout << "INFO in RapidMemory::print : memory held by each subsystem (" << labels_.back() << ") follows:" << std::endl;
+	Long64_t total(0);
+	for(unsigned int i=0; i<subsystems_.back().size(); ++i) {
+		printf("%-20s\t%12.3f MB\n", subsystems_.back()[i].Data(), bytes_.back()[i]/1.e6);
+		total += bytes_.back()[i];
+	}
+	printf("%-20s\t%12.3f MB\n", "total", total/1.e6);
+	printf("%-20s\t%12.3f MB\n", "process resident", resident_.back()/1.e6);
+}
+
+void RapidMemory::addToSummary(RapidSummary& summary) {
+	summary.beginArray("memory");
+	for(unsigned int i=0; i<labels_.size(); ++i) {
+		summary.beginObject();
+		summary.add("label", labels_[i]);
+		summary.add("time", times_[i]);
+		summary.add("resident", resident_[i]);
+		summary.beginObject("subsystems");
+		for(unsigned int j=0; j<subsystems_[i].size(); ++j) {
+			summary.add(subsystems_[i][j], bytes_[i][j]);
+		}
+		summary.endObject();
+		summary.endObject();
+	}
+	summary.endArray();
+}
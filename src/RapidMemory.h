@@ -0,0 +1,44 @@
+#ifndef RAPIDMEMORY_H
+#define RAPIDMEMORY_H
+
+#include <ctime>
+#include <vector>
+
+#include "TH1.h"
+#include "TString.h"
+
+class RooDataSet;
+class RapidSummary;
+
+//records snapshots of the memory held by each subsystem
+class RapidMemory {
+	public:
+		RapidMemory()
+			: start_(time(0))
+			{}
+
+		~RapidMemory() {}
+
+		//estimates of the memory held by common objects
+		static Long64_t histBytes(TH1* hist);
+		static Long64_t dataSetBytes(RooDataSet* data);
+		static Long64_t residentBytes();
+
+		//start a new snapshot and add the bytes held by each subsystem to it
+		void snapshot(TString label);
+		void add(TString subsystem, Long64_t bytes);
+
+		void print();
+		void addToSummary(RapidSummary& summary);
+
+	private:
+		time_t start_;
+
+		std::vector<TString> labels_;
+		std::vector<double> times_;
+		std::vector<Long64_t> resident_;
+		std::vector<std::vector<TString> > subsystems_;
+		std::vector<std::vector<Long64_t> > bytes_;
+};
+
+#endif
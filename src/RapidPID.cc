@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "RapidMemory.h"
+
 RapidPID::~RapidPID() {
 	std::map<unsigned int, TH3D*>::iterator itr = pidHists_.begin();
 	while (itr != pidHists_.end()) {
@@ -93,3 +95,24 @@ void RapidPID::limitRangePEta(unsigned int id, double& p, double& eta) {
 	if(eta < minEta_[id]) eta = minEta_[id];
 	if(eta > maxEta_[id]) eta = maxEta_[id];
 }
+
+Long64_t RapidPID::histogramBytes() {
+	Long64_t bytes(0);
+	std::map<unsigned int, TH3D*>::iterator itr = pidHists_.begin();
+	for( ; itr != pidHists_.end(); ++itr) {
+		bytes += RapidMemory::histBytes(itr->second);
+	}
+	return bytes;
+}
+
+Long64_t RapidPID::cacheBytes() {
+	Long64_t bytes(0);
+	std::map<unsigned int, std::map<unsigned int, TH1D*>*>::iterator itr = cachedPIDHists_.begin();
+	for( ; itr != cachedPIDHists_.end(); ++itr) {
+		std::map<unsigned int, TH1D*>::iterator itr2 = itr->second->begin();
+		for( ; itr2 != itr->second->end(); ++itr2) {
+			bytes += RapidMemory::histBytes(itr2->second);
+		}
+	}
+	return bytes;
+}
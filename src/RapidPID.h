@@ -17,6 +17,10 @@ class RapidPID {
 		double getPID(unsigned int id, double p, double eta);
 		void addPID(unsigned int id, TH3D* hist);
 
+		//memory held by the loaded histograms and by the cached projections
+		Long64_t histogramBytes();
+		Long64_t cacheBytes();
+
 	private:
 		void setupRangePEta(unsigned int id);
 		void limitRangePEta(unsigned int id, double& p, double& eta);
@@ -259,7 +259,7 @@ bool RapidParam::canBeTrue() {
 double RapidParam::evalPID() {
 	double pid(0.);
 	if (particles_[0]->stable() && particles_[0]->mass() > 0.) {
-		RapidParticleData * particleData = RapidParticleData::getInstance();
+		RapidParticleData * particleData = particles_[0]->particleData();
 		unsigned int id(0);
 		if (particles_[0]->massHypothesisName() == "") id = TMath::Abs(particles_[0]->id());
 		else id = TMath::Abs(particleData->pdgCode(particles_[0]->massHypothesisName()));
@@ -686,7 +686,7 @@ void RapidParam::setMassMinMax(const std::vector<RapidParticle*>& parts, double&
 		//now check to see if we've used any alternative mass hypotheses and extend range if necessary
 		double deltaDown(0.), deltaUp(0.);
 
-		RapidParticleData::getInstance()->getMaxAltHypothesisMassShifts(parts,deltaDown,deltaUp);
+		parts[0]->particleData()->getMaxAltHypothesisMassShifts(parts,deltaDown,deltaUp);
 
 		//TODO factor of 2. is arbitrary - there is probably a better way to calculate these
 		min+=2.*deltaDown;
@@ -694,7 +694,7 @@ void RapidParam::setMassMinMax(const std::vector<RapidParticle*>& parts, double&
 
 		if(min<0.) min=0.;
 	} else {
-		RapidParticleData* rpd = RapidParticleData::getInstance();
+		RapidParticleData* rpd = parts[0]->particleData();
 
 		//first check whether any of the particles we've been given have a hierarchical relationship
 		if(rpd->checkHierarchy(parts)) {
@@ -746,7 +746,7 @@ void RapidParam::setMassMinMax(const std::vector<RapidParticle*>& parts, double&
 		//now check to see if we've used any alternative mass hypotheses and extend range if necessary
 		double deltaDown(0.), deltaUp(0.);
 
-		RapidParticleData::getInstance()->getMaxAltHypothesisMassShifts(parts,deltaDown,deltaUp);
+		parts[0]->particleData()->getMaxAltHypothesisMassShifts(parts,deltaDown,deltaUp);
 
 		//TODO factor of 2. is arbitrary - there is probably a better way to calculate these
 		min+=2.*deltaDown;
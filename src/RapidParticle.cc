@@ -6,6 +6,7 @@
 #include "TRandom.h"
 
 #include "RapidIPSmearGauss.h"
+#include "RapidMemory.h"
 #include "RapidMomentumSmearEnergyGauss.h"
 #include "RapidMomentumSmearGauss.h"
 #include "RapidMomentumSmearHisto.h"
@@ -189,6 +190,10 @@ void RapidParticle::floatMass() {
 	}
 }
 
+Long64_t RapidParticle::massDataBytes() {
+	return RapidMemory::dataSetBytes(massData_);
+}
+
 void RapidParticle::updateDaughterMass(unsigned int index) {
 	if(index<daughters_.size()) {
 		daughterMasses_[index] = daughters_[index]->mass_;
@@ -16,9 +16,9 @@ class RapidIPSmear;
 
 class RapidParticle {
 	public:
-		RapidParticle(int id, TString name, double mass, double charge, double ctau, RapidParticle* mother)
+		RapidParticle(int id, TString name, double mass, double charge, double ctau, RapidParticle* mother, RapidParticleData* particleData)
 			: index_(0), id_(id), name_(name), mass_(mass), charge_(charge), ctau_(ctau),
-			  mother_(mother), next_(0), invisible_(false), momSmear_(0), ipSmear_(0),
+			  mother_(mother), next_(0), particleData_(particleData), invisible_(false), momSmear_(0), ipSmear_(0),
 			  massData_(0), minMass_(mass), maxMass_(mass),
 			  evtGenModel_("PHSP"),
 			  currentHypothesis_(0),
@@ -56,6 +56,9 @@ class RapidParticle {
 		double minMass() { return minMass_; }
 		double maxMass() { return maxMass_; }
 
+		//the particle data that the particle was made from
+		RapidParticleData* particleData() { return particleData_; }
+
 		RapidVertex * getOriginVertex() {return originVertex_;}
 		RapidVertex * getDecayVertex() {return decayVertex_;}
 
@@ -81,6 +84,8 @@ class RapidParticle {
 		void setInvisible(bool invisible=true) { invisible_ = invisible; }
 		void setSmearing(RapidMomentumSmear* momSmear) { momSmear_ = momSmear; }
 		void setSmearing(RapidIPSmear* ipSmear) { ipSmear_ = ipSmear; }
+		RapidMomentumSmear* momentumSmearing() { return momSmear_; }
+		RapidIPSmear* ipSmearing() { return ipSmear_; }
 
 		void setP(TLorentzVector p) { p_ = p; }
 		void setIP(double ip) { ip_ = ip; }
@@ -97,6 +102,7 @@ class RapidParticle {
 
 		void setMassShape(RooDataSet* ds, double minMass, double maxMass, TString varName);
 		void floatMass();
+		Long64_t massDataBytes();
 
 		TString evtGenDecayModel() { return evtGenModel_; }
 		void setEvtGenDecayModel(TString value) { evtGenModel_ = value; }
@@ -124,6 +130,8 @@ class RapidParticle {
 		RapidParticle* next_;
 		std::vector<double> daughterMasses_;
 
+		RapidParticleData* particleData_;
+
 		double fd_;
 		double ip_;
 		double minip_;
@@ -8,20 +8,15 @@
 #include "RooGounarisSakurai.h"
 
 #include "RapidParticle.h"
+#include "RapidResourceCache.h"
 
-RapidParticleData* RapidParticleData::instance_=0;
+void RapidParticleData::loadDefaults() {
+	TString path;
+	path=getenv("RAPIDSIM_CONFIG");
+	if(path!="") loadData(path+"/config/particles.dat");
 
-RapidParticleData* RapidParticleData::getInstance() {
-	if(!instance_) {
-		instance_ = new RapidParticleData();
-		TString path;
-		path=getenv("RAPIDSIM_CONFIG");
-		if(path!="") instance_->loadData(path+"/config/particles.dat");
-
-		path=getenv("RAPIDSIM_ROOT");
-		instance_->loadData(path+"/config/particles.dat");
-	}
-	return instance_;
+	path=getenv("RAPIDSIM_ROOT");
+	loadData(path+"/config/particles.dat");
 }
 
 void RapidParticleData::loadData(TString file) {
@@ -140,7 +135,7 @@ RapidParticle* RapidParticleData::makeParticle(int id, RapidParticle* mother) {
 	TString name = getName(id);
 	name = makeUniqName(name);
 
-	return new RapidParticle(id, name, mass, charge, ctau, mother);
+	return new RapidParticle(id, name, mass, charge, ctau, mother, this);
 }
 
 RapidParticle* RapidParticleData::makeParticle(TString name, RapidParticle* mother) {
@@ -151,7 +146,7 @@ RapidParticle* RapidParticleData::makeParticle(TString name, RapidParticle* moth
 	double charge = getCharge(id);
 	name = makeUniqName(name);
 
-	return new RapidParticle(id, name, mass, charge, ctau, mother);
+	return new RapidParticle(id, name, mass, charge, ctau, mother, this);
 }
 
 void RapidParticleData::setupMass(RapidParticle* part) {
@@ -190,8 +185,19 @@ void RapidParticleData::setupMass(RapidParticle* part) {
 		return;
 	}
 
-	double mmin = mass - 100.*width;
-	double mmax = mass + 100.*width;
+	//a long-lived process only generates each lineshape once
+	RapidResourceCache* cache = RapidResourceCache::getInstance();
+	TString key = TString::Format("%d %d %d %.9g %.9g %.9g %.9g %.9g %d", id, idA, idB, mA, mB, mass, width, spin, shape);
+	double mmin(0.), mmax(0.);
+	TString cachedVarName;
+	RooDataSet* cachedData = cache->getMassData(key, mmin, mmax, cachedVarName);
+	if(cachedData) {
+		part->setMassShape(cachedData,mmin,mmax,cachedVarName);
+		return;
+	}
+
+	mmin = mass - 100.*width;
+	mmax = mass + 100.*width;
 
 	RooRealVar m(varName,varName,mmin,mmax);
 	RooAbsPdf* pdf(0);
@@ -209,6 +215,7 @@ void RapidParticleData::setupMass(RapidParticle* part) {
 	RooDataSet* massdata = pdf->generate(RooArgSet(m),100000);
 	massdata->getRange(m,mmin,mmax);
 	part->setMassShape(massdata,mmin,mmax,varName);
+	cache->addMassData(key,massdata,mmin,mmax,varName);
 }
 
 void RapidParticleData::addEntry(int id, TString name, double mass, double width, double spin, double charge, TString lineshape, double ctau) {
@@ -19,8 +19,13 @@ class RapidParticleData {
 			GS
 		};
 
-		static RapidParticleData* getInstance();
+		RapidParticleData()
+		: narrowWidth_(0.001) {}
 
+		~RapidParticleData() {}
+
+		//load particles.dat from RAPIDSIM_CONFIG and RAPIDSIM_ROOT
+		void loadDefaults();
 		void loadData(TString file);
 
 		double getCT(int id);
@@ -55,13 +60,6 @@ class RapidParticleData {
 		void getMaxAltHypothesisMassShifts(RapidParticle* parts, double& deltaDown, double& deltaUp);
 
 	private:
-		static RapidParticleData* instance_;
-
-		RapidParticleData()
-		: narrowWidth_(0.001) {}
-
-		~RapidParticleData() {}
-
 		//copy constructor and copy assignment operator not implemented
 		RapidParticleData( const RapidParticleData& other );
 		RapidParticleData& operator=( const RapidParticleData& other );
@@ -0,0 +1,107 @@
+#include "RapidProfiler.h"
+
+#include <cstdio>
+#include <iostream>
+
+#include "RapidSummary.h"
+
+TString RapidProfiler::stageName(Stage stage) {
+	switch(stage) {
+		case LOADDECAY:
+			return "loadDecay";
+		case LOADCONFIG:
+			return "loadConfig";
+		case SETUPMASS:
+			return "setupMass";
+		case LOADPARENTKINEMATICS:
+			return "loadParentKinematics";
+		case LOADPID:
+			return "loadPID";
+		case ACCREJDENOMINATOR:
+			return "accRejDenominator";
+		case FLOATMASSES:
+			return "floatMasses";
+		case GENPARENT:
+			return "genParent";
+		case GENDECAY:
+			return "genDecay";
+		case SMEARMOMENTA:
+			return "smearMomenta";
+		case CALCIPS:
+			return "calcIPs";
+		case ISSELECTED:
+			return "isSelected";
+		case FILL:
+			return "fill";
+		case SAVE:
+			return "save";
+		case NSTAGES:
+		default:
+			return "unknown";
+	}
+}
+
+void RapidProfiler::setup() {
+	//stopwatches start running when they are created
+	for(unsigned int i=0; i<timers_.size(); ++i) {
+		timers_[i].Reset();
+	}
+}
+
+void RapidProfiler::print() {
+	std::cout << "INFO in RapidProfiler::print : time spent in each stage follows:" << std::endl;
+	printf("stage\t\t\tcalls\t\twall (s)\tCPU (s)\t\twall per call (us)\n");
+	for(int i=0; i<NSTAGES; ++i) {
+		if(calls_[i]==0) continue;
+		double wall = timers_[i].RealTime();
+		double cpu = timers_[i].CpuTime();
+		printf("%-20s\t%-12lld\t%-12.3f\t%-12.3f\t%.3f\n", stageName(static_cast<Stage>(i)).Data(), calls_[i], wall, cpu, 1.e6*wall/calls_[i]);
+	}
+}
+
+void RapidProfiler::addToSummary(RapidSummary& summary) {
+	summary.beginObject("stages");
+	for(int i=0; i<NSTAGES; ++i) {
+		if(calls_[i]==0) continue;
+		summary.beginObject(stageName(static_cast<Stage>(i)));
+		summary.add("calls", calls_[i]);
+		summary.add("wall", timers_[i].RealTime());
+		summary.add("cpu", timers_[i].CpuTime());
+		summary.endObject();
+	}
+	summary.endObject();
+
+	addCounts(summary, "genDecayAttempts", attempts_);
+	addCounts(summary, "accRejTries", accRejTries_);
+}
+
+void RapidProfiler::fillCount(std::vector<Long64_t>& counts, int n) {
+	if(n<0) n=0;
+	if(n>=static_cast<int>(counts.size())) n=counts.size()-1;
+	++counts[n];
+}
+
+void RapidProfiler::addCounts(RapidSummary& summary, TString key, const std::vector<Long64_t>& counts) {
+	Long64_t entries(0);
+	double sum(0.);
+	int max(0);
+	for(unsigned int i=0; i<counts.size(); ++i) {
+		entries += counts[i];
+		sum += static_cast<double>(i)*counts[i];
+		if(counts[i]>0) max = i;
+	}
+	if(entries==0) return;
+
+	//only store bins up to the largest value seen to keep the summary short
+	summary.beginObject(key);
+	summary.add("entries", entries);
+	summary.add("mean", sum/entries);
+	summary.add("max", max);
+	summary.add("overflowBin", static_cast<int>(counts.size())-1);
+	summary.beginArray("counts");
+	for(int i=0; i<=max; ++i) {
+		summary.addValue(counts[i]);
+	}
+	summary.endArray();
+	summary.endObject();
+}
@@ -0,0 +1,68 @@
+#ifndef RAPIDPROFILER_H
+#define RAPIDPROFILER_H
+
+#include <vector>
+
+#include "TStopwatch.h"
+#include "TString.h"
+
+class RapidSummary;
+
+//records the wall and CPU time and number of calls of each stage of a run
+class RapidProfiler {
+	public:
+		enum Stage {
+			//initialisation
+			LOADDECAY,
+			LOADCONFIG,
+			SETUPMASS,
+			LOADPARENTKINEMATICS,
+			LOADPID,
+			ACCREJDENOMINATOR,
+			//per event
+			FLOATMASSES,
+			GENPARENT,
+			GENDECAY,
+			SMEARMOMENTA,
+			CALCIPS,
+			ISSELECTED,
+			FILL,
+			SAVE,
+			NSTAGES
+		};
+
+		static TString stageName(Stage stage);
+
+		RapidProfiler(int maxAttempts=1000)
+			: calls_(NSTAGES, 0), timers_(NSTAGES),
+			  attempts_(maxAttempts+1, 0), accRejTries_(maxAttempts+1, 0)
+			{setup();}
+
+		~RapidProfiler() {}
+
+		void start(Stage stage) { timers_[stage].Start(kFALSE); }
+		void stop(Stage stage) { timers_[stage].Stop(); ++calls_[stage]; }
+
+		//number of TGenPhaseSpace attempts needed to decay an event
+		void fillAttempts(int n) { fillCount(attempts_, n); }
+		//number of tries needed to pass the accept/reject histogram
+		void fillAccRejTries(int n) { fillCount(accRejTries_, n); }
+
+		void print();
+		void addToSummary(RapidSummary& summary);
+
+	private:
+		void setup();
+
+		static void fillCount(std::vector<Long64_t>& counts, int n);
+		static void addCounts(RapidSummary& summary, TString key, const std::vector<Long64_t>& counts);
+
+		std::vector<Long64_t> calls_;
+		std::vector<TStopwatch> timers_;
+
+		//histograms of attempts - the last bin also counts any larger values
+		std::vector<Long64_t> attempts_;
+		std::vector<Long64_t> accRejTries_;
+};
+
+#endif
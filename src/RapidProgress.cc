@@ -0,0 +1,181 @@
+#include "RapidProgress.h"
+
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include "TSystem.h"
+#include "TTimeStamp.h"
+
+#include "RapidEfficiency.h"
+
+RapidProgress::~RapidProgress() {
+	if(started_ && !finished_ && !metricsFile_.IsNull()) writeMetrics(false);
+}
+
+void RapidProgress::start(int n, int nGenerated, int nSelected) {
+	started_ = true;
+	start_ = now();
+	last_ = start_;
+	lastGenerated_ = nGenerated;
+
+	nFirst_ = n;
+	nGeneratedFirst_ = nGenerated;
+	nSelectedFirst_ = nSelected;
+
+	n_ = n;
+	nGenerated_ = nGenerated;
+	nSelected_ = nSelected;
+
+	if(!metricsFile_.IsNull()) {
+		std::cout << "INFO in RapidProgress::start : writing metrics to file: " << metricsFile_ << std::endl;
+		writeMetrics(false);
+	}
+}
+
+void RapidProgress::finish(int n, int nGenerated, int nSelected) {
+	finished_ = true;
+	double t = now();
+	if(t>last_) rate_ = (nGenerated-lastGenerated_)/(t-last_);
+	last_ = t;
+	lastGenerated_ = nGenerated;
+
+	n_ = n;
+	nGenerated_ = nGenerated;
+	nSelected_ = nSelected;
+
+	if(print_) report(true);
+	if(!metricsFile_.IsNull()) writeMetrics(true);
+}
+
+void RapidProgress::check(int n, int nGenerated, int nSelected) {
+	double t = now();
+	if(t-last_ < interval_) return;
+
+	rate_ = (nGenerated-lastGenerated_)/(t-last_);
+	last_ = t;
+	lastGenerated_ = nGenerated;
+
+	n_ = n;
+	nGenerated_ = nGenerated;
+	nSelected_ = nSelected;
+
+	if(print_) report(false);
+	if(!metricsFile_.IsNull()) writeMetrics(false);
+}
+
+void RapidProgress::report(bool complete) {
+	double elapsed = last_-start_;
+	double average = elapsed>0. ? (nGenerated_-nGeneratedFirst_)/elapsed : 0.;
+	double efficiency = nGenerated_>0 ? static_cast<double>(nSelected_)/nGenerated_ : 0.;
+
+	std::cout << "INFO in RapidProgress::report : " << n_ << " parents, " << nGenerated_ << " generated, " << nSelected_ << " selected"
+		  << " (efficiency " << 100.*efficiency << "%)" << std::endl
+		  << "                                " << rate_ << " events/s (average " << average << " events/s)";
+
+	double remaining = eta();
+	if(complete) {
+		std::cout << ", complete after " << elapsed << " s" << std::endl;
+	} else if(remaining>=0.) {
+		std::cout << ", " << elapsed << " s elapsed, about " << remaining << " s remaining" << std::endl;
+	} else {
+		std::cout << ", " << elapsed << " s elapsed" << std::endl;
+	}
+}
+
+void RapidProgress::writeMetrics(bool complete) {
+	double elapsed = last_-start_;
+	double average = elapsed>0. ? (nGenerated_-nGeneratedFirst_)/elapsed : 0.;
+	double efficiency = nGenerated_>0 ? static_cast<double>(nSelected_)/nGenerated_ : 0.;
+	double remaining = complete ? 0. : eta();
+
+	//backslashes and quotes must be escaped in a label value
+	TString value = label_;
+	value.ReplaceAll("\\", "\\\\");
+	value.ReplaceAll("\"", "\\\"");
+	value.ReplaceAll("\n", "\\n");
+	TString label = "{mode=\"";
+	label += value;
+	label += "\"}";
+
+	//write to a temporary file and move it into place so a scrape never sees a partial file
+	std::ofstream fout;
+	fout.open(metricsFile_+".tmp", std::ofstream::out);
+	if(!fout.good()) {
+		std::cout << "WARNING in RapidProgress::writeMetrics : failed to open file " << metricsFile_ << "." << std::endl;
+		return;
+	}
+	fout.precision(12);
+
+	fout << "# HELP rapidsim_parents_total Number of parents processed.\n"
+	     << "# TYPE rapidsim_parents_total counter\n"
+	     << "rapidsim_parents_total" << label << " " << n_ << "\n";
+	fout << "# HELP rapidsim_generated_total Number of decays generated.\n"
+	     << "# TYPE rapidsim_generated_total counter\n"
+	     << "rapidsim_generated_total" << label << " " << nGenerated_ << "\n";
+	fout << "# HELP rapidsim_selected_total Number of decays selected.\n"
+	     << "# TYPE rapidsim_selected_total counter\n"
+	     << "rapidsim_selected_total" << label << " " << nSelected_ << "\n";
+	fout << "# HELP rapidsim_efficiency Fraction of generated decays that are selected.\n"
+	     << "# TYPE rapidsim_efficiency gauge\n"
+	     << "rapidsim_efficiency" << label << " " << efficiency << "\n";
+	fout << "# HELP rapidsim_rate_events_per_second Decays generated per second since the previous update.\n"
+	     << "# TYPE rapidsim_rate_events_per_second gauge\n"
+	     << "rapidsim_rate_events_per_second" << label << " " << rate_ << "\n";
+	fout << "# HELP rapidsim_average_rate_events_per_second Decays generated per second since the start of the run.\n"
+	     << "# TYPE rapidsim_average_rate_events_per_second gauge\n"
+	     << "rapidsim_average_rate_events_per_second" << label << " " << average << "\n";
+	fout << "# HELP rapidsim_elapsed_seconds Time since the start of the event loop.\n"
+	     << "# TYPE rapidsim_elapsed_seconds gauge\n"
+	     << "rapidsim_elapsed_seconds" << label << " " << elapsed << "\n";
+	fout << "# HELP rapidsim_eta_seconds Estimated time until the run completes.\n"
+	     << "# TYPE rapidsim_eta_seconds gauge\n"
+	     << "rapidsim_eta_seconds" << label << " ";
+	if(remaining>=0.) fout << remaining << "\n";
+	else fout << "NaN\n";
+	fout << "# HELP rapidsim_complete Whether the event loop has finished.\n"
+	     << "# TYPE rapidsim_complete gauge\n"
+	     << "rapidsim_complete" << label << " " << (complete ? 1 : 0) << "\n";
+	fout << "# HELP rapidsim_last_update_timestamp_seconds Time of the last update, to spot stuck jobs.\n"
+	     << "# TYPE rapidsim_last_update_timestamp_seconds gauge\n"
+	     << "rapidsim_last_update_timestamp_seconds" << label << " " << last_ << "\n";
+	fout.close();
+
+	gSystem->Rename(metricsFile_+".tmp", metricsFile_);
+}
+
+double RapidProgress::now() {
+	TTimeStamp now;
+	return now.AsDouble();
+}
+
+double RapidProgress::eta() {
+	double elapsed = last_-start_;
+	if(elapsed<=0.) return -1.;
+
+	if(efficiency_) {
+		//the relative uncertainty falls as the square root of the number generated
+		double uncertainty = efficiency_->uncertainty();
+		double target = efficiency_->target();
+		double rate = (nGenerated_-nGeneratedFirst_)/elapsed;
+		if(uncertainty>1. || rate<=0.) return -1.;
+		if(uncertainty<=target) return 0.;
+		double needed = nGenerated_*(uncertainty*uncertainty/(target*target) - 1.);
+		return needed/rate;
+	}
+
+	if(nTarget_>0) {
+		double rate = (nSelected_-nSelectedFirst_)/elapsed;
+		if(rate<=0.) return -1.;
+		return (nTarget_-nSelected_)/rate;
+	}
+
+	if(nMax_>0 && nMax_<INT_MAX) {
+		double rate = (n_-nFirst_)/elapsed;
+		if(rate<=0.) return -1.;
+		return (nMax_-n_)/rate;
+	}
+
+	return -1.;
+}
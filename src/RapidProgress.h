@@ -0,0 +1,76 @@
+#ifndef RAPIDPROGRESS_H
+#define RAPIDPROGRESS_H
+
+#include "TString.h"
+
+class RapidEfficiency;
+
+//reports the progress of the event loop to stdout and to a Prometheus metrics file
+class RapidProgress {
+	public:
+		RapidProgress(TString label, double interval, bool print, TString metricsFile="")
+			: label_(label), interval_(interval), print_(print), metricsFile_(metricsFile),
+			  nMax_(0), nTarget_(0), efficiency_(0),
+			  nCalls_(0), start_(0.), last_(0.), lastGenerated_(0),
+			  nFirst_(0), nGeneratedFirst_(0), nSelectedFirst_(0),
+			  n_(0), nGenerated_(0), nSelected_(0), rate_(0.), started_(false), finished_(false)
+			{}
+
+		~RapidProgress();
+
+		//what the run is aiming for, used to estimate the time remaining
+		void setMaxParents(int nMax) { nMax_ = nMax; }
+		void setTargetSelected(int nTarget) { nTarget_ = nTarget; }
+		void setEfficiency(RapidEfficiency* efficiency) { efficiency_ = efficiency; }
+
+		void start(int n, int nGenerated, int nSelected);
+
+		void update(int n, int nGenerated, int nSelected) {
+			//only look at the clock occasionally to keep the overhead negligible
+			if((++nCalls_ & 0x3f)==0) check(n, nGenerated, nSelected);
+		}
+
+		void finish(int n, int nGenerated, int nSelected);
+
+	private:
+		void check(int n, int nGenerated, int nSelected);
+		void report(bool complete);
+		void writeMetrics(bool complete);
+
+		double now();
+		double eta();
+
+		TString label_;
+		double interval_;
+		//whether to report to stdout as well as to the metrics file
+		bool print_;
+		TString metricsFile_;
+
+		int nMax_;
+		int nTarget_;
+		RapidEfficiency* efficiency_;
+
+		Long64_t nCalls_;
+
+		//times in seconds since the epoch
+		double start_;
+		double last_;
+		int lastGenerated_;
+
+		//counts when the loop started, which may be resuming an earlier run
+		int nFirst_;
+		int nGeneratedFirst_;
+		int nSelectedFirst_;
+
+		//state at the last report
+		int n_;
+		int nGenerated_;
+		int nSelected_;
+		double rate_;
+
+		//a run that stops without finishing still leaves its last state in the metrics file
+		bool started_;
+		bool finished_;
+};
+
+#endif
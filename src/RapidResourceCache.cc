@@ -0,0 +1,177 @@
+#include "RapidResourceCache.h"
+
+#include <iostream>
+
+#include "TClass.h"
+#include "TH1.h"
+#include "TSystem.h"
+
+#include "RooDataSet.h"
+
+#include "RapidMemory.h"
+
+RapidResourceCache* RapidResourceCache::instance_=0;
+
+RapidResourceCache* RapidResourceCache::getInstance() {
+	if(!instance_) {
+		instance_ = new RapidResourceCache();
+	}
+	return instance_;
+}
+
+TFile* RapidResourceCache::openFile(TString fileName) {
+	if(!enabled_) return TFile::Open(fileName);
+
+	//files that are not on the local filesystem are not cached
+	Long_t id(0), flags(0), modified(0);
+	Long64_t size(0);
+	if(gSystem->GetPathInfo(fileName, &id, &size, &flags, &modified)) return TFile::Open(fileName);
+
+	std::map<TString, TFile*>::iterator it = files_.find(fileName);
+	if(it != files_.end()) {
+		if(modified_[fileName] == modified) {
+			++hits_;
+			return it->second;
+		}
+
+		//the file has been rewritten since it was cached so drop it and everything read from it
+		std::cout << "INFO in RapidResourceCache::openFile : " << fileName << " has been modified." << std::endl
+			  << "                                       Objects read from it will be reloaded." << std::endl;
+		TString prefix = fileName+":";
+		std::map<TString, TObject*>::iterator itObj = objects_.begin();
+		while(itObj != objects_.end()) {
+			if(itObj->first.BeginsWith(prefix)) {
+				delete itObj->second;
+				objects_.erase(itObj++);
+			} else {
+				++itObj;
+			}
+		}
+		it->second->Close();
+		delete it->second;
+		files_.erase(it);
+	}
+
+	++misses_;
+	TFile* file = TFile::Open(fileName);
+	if(!file) return 0;
+
+	files_[fileName] = file;
+	modified_[fileName] = modified;
+	return file;
+}
+
+void RapidResourceCache::closeFile(TFile* file) {
+	if(!file) return;
+
+	//cached files stay open for the next job
+	if(enabled_ && files_.count(file->GetName()) && files_[file->GetName()]==file) return;
+
+	file->Close();
+}
+
+TObject* RapidResourceCache::getObject(TFile* file, TString name) {
+	if(!file) return 0;
+	if(!enabled_) return file->Get(name);
+
+	TString key = file->GetName();
+	key += ":";
+	key += name;
+
+	TObject* master(0);
+	std::map<TString, TObject*>::iterator it = objects_.find(key);
+	if(it != objects_.end()) {
+		++hits_;
+		master = it->second;
+	} else {
+		++misses_;
+		master = file->Get(name);
+		if(!master) return 0;
+		//the master copy belongs to the cache rather than the file
+		TH1* hist = dynamic_cast<TH1*>(master);
+		if(hist) hist->SetDirectory(0);
+		objects_[key] = master;
+	}
+
+	//the caller may modify or delete its copy
+	TObject* copy = master->Clone();
+	TH1* hist = dynamic_cast<TH1*>(copy);
+	if(hist) hist->SetDirectory(0);
+	return copy;
+}
+
+RooDataSet* RapidResourceCache::getMassData(TString key, double& minMass, double& maxMass, TString& varName) {
+	if(!enabled_) return 0;
+
+	std::map<TString, MassData>::iterator it = massData_.find(key);
+	if(it == massData_.end()) {
+		++misses_;
+		return 0;
+	}
+
+	++hits_;
+	minMass = it->second.minMass;
+	maxMass = it->second.maxMass;
+	varName = it->second.varName;
+	return it->second.data;
+}
+
+void RapidResourceCache::addMassData(TString key, RooDataSet* data, double minMass, double maxMass, TString varName) {
+	if(!enabled_ || massData_.count(key)) return;
+
+	MassData entry;
+	entry.data = data;
+	entry.minMass = minMass;
+	entry.maxMass = maxMass;
+	entry.varName = varName;
+	massData_[key] = entry;
+}
+
+Long64_t RapidResourceCache::bytes() {
+	Long64_t bytes(0);
+
+	std::map<TString, TObject*>::iterator it = objects_.begin();
+	for( ; it!=objects_.end(); ++it) {
+		TH1* hist = dynamic_cast<TH1*>(it->second);
+		if(hist) bytes += RapidMemory::histBytes(hist);
+		else bytes += it->second->IsA()->Size();
+	}
+
+	std::map<TString, MassData>::iterator itMass = massData_.begin();
+	for( ; itMass!=massData_.end(); ++itMass) {
+		bytes += RapidMemory::dataSetBytes(itMass->second.data);
+	}
+
+	return bytes;
+}
+
+void RapidResourceCache::print() {
+	std::cout << "INFO in RapidResourceCache::print : " << files_.size() << " files, " << objects_.size() << " objects and "
+		  << massData_.size() << " lineshapes cached (" << bytes()/1e6 << " MB)" << std::endl
+		  << "                                    " << hits_ << " hits and " << misses_ << " misses" << std::endl;
+}
+
+void RapidResourceCache::clear() {
+	std::map<TString, TObject*>::iterator it = objects_.begin();
+	for( ; it!=objects_.end(); ++it) {
+		delete it->second;
+	}
+	objects_.clear();
+
+	std::map<TString, MassData>::iterator itMass = massData_.begin();
+	for( ; itMass!=massData_.end(); ++itMass) {
+		delete itMass->second.data;
+	}
+	massData_.clear();
+
+	std::map<TString, TFile*>::iterator itFile = files_.begin();
+	for( ; itFile!=files_.end(); ++itFile) {
+		itFile->second->Close();
+		delete itFile->second;
+	}
+	files_.clear();
+	modified_.clear();
+
+	hits_ = 0;
+	misses_ = 0;
+}
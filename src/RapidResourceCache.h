@@ -0,0 +1,77 @@
+#ifndef RAPIDRESOURCECACHE_H
+#define RAPIDRESOURCECACHE_H
+
+#include <map>
+
+#include "TFile.h"
+#include "TObject.h"
+#include "TString.h"
+
+class RooDataSet;
+
+//keeps the ROOT files and objects loaded from config/ and rootfiles/ between the jobs of a long-lived process
+//when disabled, files are opened and objects read as if there were no cache
+class RapidResourceCache {
+	public:
+		static RapidResourceCache* getInstance();
+
+		void setEnabled(bool enabled) { enabled_ = enabled; }
+		bool enabled() { return enabled_; }
+
+		//open a file, reusing the open file if it has not been modified since it was cached
+		TFile* openFile(TString fileName);
+		void closeFile(TFile* file);
+
+		//read an object from a file opened with openFile - the caller owns the returned object
+		TObject* getObject(TFile* file, TString name);
+
+		//generated mass lineshapes - the cache owns the datasets
+		RooDataSet* getMassData(TString key, double& minMass, double& maxMass, TString& varName);
+		void addMassData(TString key, RooDataSet* data, double minMass, double maxMass, TString varName);
+
+		//memory held by the cached objects
+		Long64_t bytes();
+
+		void print();
+		void clear();
+
+	private:
+		static RapidResourceCache* instance_;
+
+		RapidResourceCache()
+		: enabled_(false), hits_(0), misses_(0) {}
+
+		~RapidResourceCache() { clear(); }
+
+		//copy constructor and copy assignment operator not implemented
+		RapidResourceCache( const RapidResourceCache& other );
+		RapidResourceCache& operator=( const RapidResourceCache& other );
+
+		class MassData {
+			public:
+				MassData()
+					: data(0), minMass(0.), maxMass(0.), varName("")
+					{}
+
+				RooDataSet* data;
+				double minMass;
+				double maxMass;
+				TString varName;
+		};
+
+		bool enabled_;
+
+		//open files and the modification time at which they were opened
+		std::map<TString, TFile*> files_;
+		std::map<TString, Long_t> modified_;
+
+		//master copies of the objects read from each file, keyed by file and object name
+		std::map<TString, TObject*> objects_;
+
+		std::map<TString, MassData> massData_;
+
+		int hits_;
+		int misses_;
+};
+
+#endif
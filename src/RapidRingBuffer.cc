@@ -0,0 +1,199 @@
+#include "RapidRingBuffer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+	//offsets of the header fields - see RapidRingBuffer.h
+	const std::size_t magicOffset = 0;
+	const std::size_t versionOffset = 8;
+	const std::size_t nColumnsOffset = 12;
+	const std::size_t capacityOffset = 16;
+	const std::size_t recordSizeOffset = 24;
+	const std::size_t dataOffsetOffset = 32;
+	const std::size_t nProducersOffset = 40;
+	const std::size_t stopOffset = 44;
+	const std::size_t nAttachedOffset = 48;
+	const std::size_t writeCursorOffset = 64;
+	const std::size_t readCursorOffset = 128;
+	const std::size_t namesOffset = 192;
+
+	const char magic[8] = {'R','A','P','I','D','S','H','M'};
+
+	//seconds to wait for a ring being created by another producer
+	const int attachTimeout = 10;
+}
+
+bool RapidRingBuffer::open(TString name, const std::vector<TString>& columns, unsigned int capacity) {
+	close();
+
+	if(!name.BeginsWith("/")) name.Prepend("/");
+	name_ = name;
+
+	if(columns.empty()) {
+		std::cout << "ERROR in RapidRingBuffer::open : no columns to write." << std::endl;
+		return false;
+	}
+	for(unsigned int i=0; i<columns.size(); ++i) {
+		if(static_cast<unsigned int>(columns[i].Length())>=nameLength) {
+			std::cout << "ERROR in RapidRingBuffer::open : column name " << columns[i] << " is too long." << std::endl;
+			return false;
+		}
+	}
+
+	//the first producer creates the ring and the others attach to it
+	fd_ = shm_open(name_.Data(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if(fd_>=0) return create(columns, capacity);
+
+	if(errno!=EEXIST) {
+		std::cout << "ERROR in RapidRingBuffer::open : failed to create shared memory " << name_ << " : " << strerror(errno) << "." << std::endl;
+		return false;
+	}
+
+	fd_ = shm_open(name_.Data(), O_RDWR, 0600);
+	if(fd_<0) {
+		std::cout << "ERROR in RapidRingBuffer::open : failed to open shared memory " << name_ << " : " << strerror(errno) << "." << std::endl;
+		return false;
+	}
+	return attach(columns);
+}
+
+bool RapidRingBuffer::create(const std::vector<TString>& columns, unsigned int capacity) {
+	//a power of two so that the position of a record does not jump when the cursors wrap
+	unsigned long long nRecords(1);
+	while(nRecords<capacity) nRecords <<= 1;
+
+	std::size_t nColumns = columns.size();
+	std::size_t recordSize = (8 + 4*nColumns + 7) & ~static_cast<std::size_t>(7);
+	std::size_t dataOffset = (namesOffset + nameLength*nColumns + 63) & ~static_cast<std::size_t>(63);
+	size_ = dataOffset + nRecords*recordSize;
+
+	if(ftruncate(fd_, size_)!=0) {
+		std::cout << "ERROR in RapidRingBuffer::create : failed to size shared memory " << name_ << " : " << strerror(errno) << "." << std::endl;
+		close();
+		return false;
+	}
+
+	memory_ = mmap(0, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+	if(memory_==MAP_FAILED) {
+		std::cout << "ERROR in RapidRingBuffer::create : failed to map shared memory " << name_ << " : " << strerror(errno) << "." << std::endl;
+		memory_ = 0;
+		close();
+		return false;
+	}
+
+	//ftruncate leaves the memory zeroed
+	char* base = static_cast<char*>(memory_);
+	memcpy(base+magicOffset, magic, sizeof(magic));
+	header32(nColumnsOffset) = nColumns;
+	header64(capacityOffset) = nRecords;
+	header64(recordSizeOffset) = recordSize;
+	header64(dataOffsetOffset) = dataOffset;
+	for(unsigned int i=0; i<nColumns; ++i) {
+		strncpy(base+namesOffset+nameLength*i, columns[i].Data(), nameLength-1);
+	}
+	for(unsigned long long i=0; i<nRecords; ++i) {
+		header64(dataOffset + i*recordSize) = i;
+	}
+
+	__atomic_add_fetch(&header32(nProducersOffset), 1, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&header32(nAttachedOffset), 1, __ATOMIC_SEQ_CST);
+
+	//the version marks the header as complete for other producers and the consumers
+	__atomic_store_n(&header32(versionOffset), version, __ATOMIC_RELEASE);
+
+	std::cout << "INFO in RapidRingBuffer::create : created shared memory " << name_ << " holding " << nRecords << " records of " << nColumns << " columns." << std::endl;
+	return true;
+}
+
+bool RapidRingBuffer::attach(const std::vector<TString>& columns) {
+	//the creating producer may not have finished setting up the ring yet
+	struct stat info;
+	int nWaits(0);
+	while(true) {
+		if(fstat(fd_, &info)==0 && static_cast<std::size_t>(info.st_size)>namesOffset) {
+			memory_ = mmap(0, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+			if(memory_==MAP_FAILED) {
+				std::cout << "ERROR in RapidRingBuffer::attach : failed to map shared memory " << name_ << " : " << strerror(errno) << "." << std::endl;
+				memory_ = 0;
+				close();
+				return false;
+			}
+			size_ = info.st_size;
+			if(__atomic_load_n(&header32(versionOffset), __ATOMIC_ACQUIRE)!=0) break;
+			munmap(memory_, size_);
+			memory_ = 0;
+			size_ = 0;
+		}
+		if(++nWaits > attachTimeout*100) {
+			std::cout << "ERROR in RapidRingBuffer::attach : shared memory " << name_ << " was not set up in time." << std::endl;
+			close();
+			return false;
+		}
+		usleep(10000);
+	}
+
+	char* base = static_cast<char*>(memory_);
+	bool matches = memcmp(base+magicOffset, magic, sizeof(magic))==0 && header32(versionOffset)==version && header32(nColumnsOffset)==columns.size();
+	for(unsigned int i=0; matches && i<columns.size(); ++i) {
+		matches = strncmp(base+namesOffset+nameLength*i, columns[i].Data(), nameLength)==0;
+	}
+	if(!matches) {
+		std::cout << "ERROR in RapidRingBuffer::attach : shared memory " << name_ << " holds a ring with different columns." << std::endl;
+		close();
+		return false;
+	}
+
+	__atomic_add_fetch(&header32(nProducersOffset), 1, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&header32(nAttachedOffset), 1, __ATOMIC_SEQ_CST);
+
+	std::cout << "INFO in RapidRingBuffer::attach : attached to shared memory " << name_ << " holding " << header64(capacityOffset) << " records." << std::endl;
+	return true;
+}
+
+void RapidRingBuffer::close() {
+	if(memory_) {
+		__atomic_sub_fetch(&header32(nProducersOffset), 1, __ATOMIC_SEQ_CST);
+		munmap(memory_, size_);
+		memory_ = 0;
+		size_ = 0;
+	}
+	if(fd_>=0) {
+		::close(fd_);
+		fd_ = -1;
+	}
+}
+
+bool RapidRingBuffer::stopped() {
+	if(!memory_) return true;
+	return __atomic_load_n(&header32(stopOffset), __ATOMIC_ACQUIRE)!=0;
+}
+
+bool RapidRingBuffer::push(const std::vector<float>& values) {
+	if(!memory_) return false;
+
+	const unsigned long long capacity = header64(capacityOffset);
+	const std::size_t recordSize = header64(recordSizeOffset);
+	const std::size_t dataOffset = header64(dataOffsetOffset);
+
+	unsigned long long position = __atomic_fetch_add(&header64(writeCursorOffset), 1, __ATOMIC_RELAXED);
+	char* record = static_cast<char*>(memory_) + dataOffset + (position & (capacity-1))*recordSize;
+	unsigned long long* sequence = reinterpret_cast<unsigned long long*>(record);
+
+	//wait for the consumer to free the record from the previous pass around the ring
+	int nSpins(0);
+	while(__atomic_load_n(sequence, __ATOMIC_ACQUIRE)!=position) {
+		if(stopped()) return false;
+		if(++nSpins>1000) usleep(50);
+	}
+
+	memcpy(record+8, &values[0], 4*header32(nColumnsOffset));
+	__atomic_store_n(sequence, position+1, __ATOMIC_RELEASE);
+	return true;
+}
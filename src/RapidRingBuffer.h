@@ -0,0 +1,70 @@
+#ifndef RAPIDRINGBUFFER_H
+#define RAPIDRINGBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "TString.h"
+
+//writes selected events as fixed-size float32 records into a POSIX shared-memory ring buffer
+//
+//several producer processes may write into the same ring, which is created by the first of them
+//the layout, in bytes from the start of the shared memory, is:
+//     0  char[8]  magic "RAPIDSHM"
+//     8  uint32   version, written last by the producer that creates the ring
+//    12  uint32   number of columns
+//    16  uint64   capacity in records, a power of two
+//    24  uint64   size of a record
+//    32  uint64   offset of the first record
+//    40  uint32   number of producers attached
+//    44  uint32   set to non-zero by a consumer to ask the producers to finish
+//    48  uint32   number of producers that have ever attached
+//    64  uint64   write cursor, the next position a producer will claim
+//   128  uint64   read cursor, the next position a consumer will claim
+//   192  char[64] name of each column, padded with zeros
+//each record starts with a uint64 sequence number followed by one float32 per column
+//position p is held in record p%capacity - it may be written once its sequence number is p and read once it is p+1
+//a producer claims p by incrementing the write cursor atomically
+//several consumers may read the ring - a consumer claims the n ready records from p with an atomic compare-and-swap of
+//the read cursor from p to p+n, copies them and frees each record by setting its sequence number to its position+capacity
+//a position claimed by a producer that stops before writing it is never ready, so consumers must also finish on the
+//stop flag or a timeout
+class RapidRingBuffer {
+	public:
+		RapidRingBuffer()
+			: name_(""), fd_(-1), memory_(0), size_(0)
+			{}
+
+		~RapidRingBuffer() { close(); }
+
+		//create the ring or attach to an existing one with the same columns
+		bool open(TString name, const std::vector<TString>& columns, unsigned int capacity);
+		void close();
+
+		//write one record - waits while the ring is full and returns false if the consumer has asked to stop
+		bool push(const std::vector<float>& values);
+
+		//whether the consumer has asked the producers to finish
+		bool stopped();
+
+		static const unsigned int version = 1;
+		static const unsigned int nameLength = 64;
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidRingBuffer( const RapidRingBuffer& other );
+		RapidRingBuffer& operator=( const RapidRingBuffer& other );
+
+		bool create(const std::vector<TString>& columns, unsigned int capacity);
+		bool attach(const std::vector<TString>& columns);
+
+		unsigned int& header32(std::size_t offset) { return *reinterpret_cast<unsigned int*>(static_cast<char*>(memory_)+offset); }
+		unsigned long long& header64(std::size_t offset) { return *reinterpret_cast<unsigned long long*>(static_cast<char*>(memory_)+offset); }
+
+		TString name_;
+		int fd_;
+		void* memory_;
+		std::size_t size_;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef RAPIDRUNOPTIONS_H
+#define RAPIDRUNOPTIONS_H
+
+#include <vector>
+
+#include "TString.h"
+
+//options for a generation run given on the command line
+class RapidRunOptions {
+	public:
+		RapidRunOptions()
+			: resume(false), checkpointInterval(0.), timeLimit(0.), nSelected(0),
+			  precision(0.), precisionPerCut(false), interval("wilson"), confidenceLevel(0.682689492137),
+			  profile(false), progressInterval(0.), metricsFile(""), memoryInterval(60.),
+			  ringName(""), ringColumns(""), ringCapacity(65536), nWorkers(0), nReSmear(0),
+			  reDecayParticle(-1), reDecayKeep(false), truthFile(""),
+			  cacheFile(""), replayFile("")
+			{}
+
+		//continue from the last checkpoint if one exists
+		bool resume;
+
+		//seconds between checkpoints or 0 for none
+		double checkpointInterval;
+
+		//seconds after which to write a checkpoint and stop or 0 for no limit
+		double timeLimit;
+
+		//number of selected events to generate or 0 to generate a fixed number of parents
+		int nSelected;
+
+		//target relative uncertainty on the efficiency or 0 to not stop on precision
+		double precision;
+		//whether the target applies to each stage of the selection as well as the total
+		bool precisionPerCut;
+		//interval used to estimate the uncertainty and its confidence level
+		TString interval;
+		double confidenceLevel;
+
+		//whether to profile each stage of the event loop
+		bool profile;
+
+		//seconds between progress reports or 0 for none
+		double progressInterval;
+		//file to write Prometheus metrics to or empty for none
+		TString metricsFile;
+
+		//seconds between records of the memory held by each subsystem or 0 for none
+		double memoryInterval;
+
+		//lines in the format of the config file applied after it has been read
+		std::vector<TString> settings;
+
+		//shared-memory ring buffer to write the selected events to or empty for none
+		TString ringName;
+		//comma-separated columns to write or empty for all
+		TString ringColumns;
+		//number of records held by the ring when it is created
+		unsigned int ringCapacity;
+
+		//number of worker processes to split the run between or 0 to generate in this process
+		unsigned int nWorkers;
+
+		//number of times to smear each decay again, keeping its true kinematics
+		int nReSmear;
+
+		//index of the particle whose sub-chain alone is re-decayed, or kept when reDecayKeep is set, or -1 for the full chain
+		int reDecayParticle;
+		bool reDecayKeep;
+
+		//ROOT or HepMC3 file to read the true decays from or empty to generate them
+		TString truthFile;
+
+		//binary file to record the true decays in, or to replay the detector response and selection from, or empty for none
+		TString cacheFile;
+		TString replayFile;
+};
+
+#endif
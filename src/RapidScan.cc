@@ -0,0 +1,185 @@
+#include "RapidScan.h"
+
+#include <cmath>
+#include <iostream>
+
+#include "TFile.h"
+
+#include "RapidParam.h"
+
+RapidScan::~RapidScan() {
+	while(!histos_.empty()) {
+		delete histos_[histos_.size()-1];
+		histos_.pop_back();
+	}
+	while(!pairHistos_.empty()) {
+		delete pairHistos_[pairHistos_.size()-1];
+		pairHistos_.pop_back();
+	}
+}
+
+bool RapidScan::addVariable(RapidParam* param, TString type, double lo, double hi, int nSteps) {
+	ScanType scanType;
+	if(type=="min") {
+		scanType = MIN;
+	} else if(type=="max") {
+		scanType = MAX;
+	} else {
+		std::cout << "ERROR in RapidScan::addVariable : unknown scan type " << type << "." << std::endl;
+		return false;
+	}
+	if(nSteps<1 || hi<=lo) {
+		std::cout << "ERROR in RapidScan::addVariable : the thresholds must rise from " << lo << " to " << hi << " in at least one step." << std::endl;
+		return false;
+	}
+
+	params_.push_back(param);
+	types_.push_back(scanType);
+	values_.push_back(0.);
+
+	unsigned int i = params_.size()-1;
+	TH1D* hist = new TH1D("scanDist_"+name(i), param->name(), nSteps, lo, hi);
+	hist->SetDirectory(0);
+	histos_.push_back(hist);
+
+	for(unsigned int j=0; j<i; ++j) {
+		TH2D* pairHist = new TH2D("scanDist_"+name(j)+"_"+name(i), param->name(),
+				histos_[j]->GetNbinsX(), histos_[j]->GetXaxis()->GetXmin(), histos_[j]->GetXaxis()->GetXmax(),
+				nSteps, lo, hi);
+		pairHist->SetDirectory(0);
+		pairHistos_.push_back(pairHist);
+		pairFirst_.push_back(j);
+		pairSecond_.push_back(i);
+	}
+
+	return true;
+}
+
+TString RapidScan::name(unsigned int i) {
+	return params_[i]->name() + (types_[i]==MIN ? "_min" : "_max");
+}
+
+void RapidScan::fill() {
+	for(unsigned int i=0; i<params_.size(); ++i) {
+		values_[i] = params_[i]->eval();
+		histos_[i]->Fill(values_[i]);
+	}
+	for(unsigned int p=0; p<pairHistos_.size(); ++p) {
+		pairHistos_[p]->Fill(values_[pairFirst_[p]], values_[pairSecond_[p]]);
+	}
+}
+
+void RapidScan::thresholdBins(unsigned int i, int threshold, int& first, int& last) {
+	//threshold k is the low edge of bin k+1 - overflows are always included
+	int nBins = histos_[i]->GetNbinsX();
+	if(types_[i]==MIN) {
+		first = threshold+1;
+		last = nBins+1;
+	} else {
+		first = 0;
+		last = threshold;
+	}
+}
+
+std::vector<double> RapidScan::cumulate1D(unsigned int i) {
+	TH1D* hist = histos_[i];
+	int nThresholds = hist->GetNbinsX()+1;
+
+	std::vector<double> counts(nThresholds, 0.);
+	for(int k=0; k<nThresholds; ++k) {
+		int first(0), last(0);
+		thresholdBins(i, k, first, last);
+		for(int bin=first; bin<=last; ++bin) {
+			counts[k] += hist->GetBinContent(bin);
+		}
+	}
+	return counts;
+}
+
+std::vector<std::vector<double> > RapidScan::cumulate2D(unsigned int pair) {
+	TH2D* hist = pairHistos_[pair];
+	unsigned int i = pairFirst_[pair];
+	unsigned int j = pairSecond_[pair];
+	int nBinsY = hist->GetNbinsY();
+	int nThresholdsX = hist->GetNbinsX()+1;
+	int nThresholdsY = nBinsY+1;
+
+	//sum over the bins passing each threshold on X first and then over those passing each threshold on Y
+	std::vector<std::vector<double> > countsX(nThresholdsX, std::vector<double>(nBinsY+2, 0.));
+	for(int k=0; k<nThresholdsX; ++k) {
+		int first(0), last(0);
+		thresholdBins(i, k, first, last);
+		for(int binX=first; binX<=last; ++binX) {
+			for(int binY=0; binY<=nBinsY+1; ++binY) {
+				countsX[k][binY] += hist->GetBinContent(binX, binY);
+			}
+		}
+	}
+
+	std::vector<std::vector<double> > counts(nThresholdsX, std::vector<double>(nThresholdsY, 0.));
+	for(int l=0; l<nThresholdsY; ++l) {
+		int first(0), last(0);
+		thresholdBins(j, l, first, last);
+		for(int k=0; k<nThresholdsX; ++k) {
+			for(int binY=first; binY<=last; ++binY) {
+				counts[k][l] += countsX[k][binY];
+			}
+		}
+	}
+	return counts;
+}
+
+void RapidScan::save(TString outputName, Long64_t nGenerated) {
+	TString fileName = outputName+"_scan.root";
+	std::cout << "INFO in RapidScan::save : saving efficiencies of " << params_.size() << " scanned parameters to file: " << fileName << std::endl;
+
+	TFile* file = new TFile(fileName, "RECREATE");
+	double n = nGenerated>0 ? static_cast<double>(nGenerated) : 1.;
+
+	for(unsigned int i=0; i<params_.size(); ++i) {
+		TAxis* axis = histos_[i]->GetXaxis();
+		int nThresholds = axis->GetNbins()+1;
+		double step = axis->GetBinWidth(1);
+
+		//one bin centred on each threshold
+		TH1D eff("eff_"+name(i), params_[i]->name()+(types_[i]==MIN ? " > threshold" : " < threshold"),
+				nThresholds, axis->GetXmin()-0.5*step, axis->GetXmax()+0.5*step);
+		eff.SetDirectory(0);
+
+		std::vector<double> counts = cumulate1D(i);
+		for(int k=0; k<nThresholds; ++k) {
+			double e = counts[k]/n;
+			eff.SetBinContent(k+1, e);
+			eff.SetBinError(k+1, std::sqrt(e*(1.-e)/n));
+		}
+		file->WriteTObject(&eff);
+		file->WriteTObject(histos_[i]);
+	}
+
+	for(unsigned int p=0; p<pairHistos_.size(); ++p) {
+		unsigned int i = pairFirst_[p];
+		unsigned int j = pairSecond_[p];
+		TAxis* axisX = histos_[i]->GetXaxis();
+		TAxis* axisY = histos_[j]->GetXaxis();
+		double stepX = axisX->GetBinWidth(1);
+		double stepY = axisY->GetBinWidth(1);
+
+		TH2D eff("eff_"+name(i)+"_"+name(j), params_[i]->name()+" vs "+params_[j]->name(),
+				axisX->GetNbins()+1, axisX->GetXmin()-0.5*stepX, axisX->GetXmax()+0.5*stepX,
+				axisY->GetNbins()+1, axisY->GetXmin()-0.5*stepY, axisY->GetXmax()+0.5*stepY);
+		eff.SetDirectory(0);
+
+		std::vector<std::vector<double> > counts = cumulate2D(p);
+		for(unsigned int k=0; k<counts.size(); ++k) {
+			for(unsigned int l=0; l<counts[k].size(); ++l) {
+				double e = counts[k][l]/n;
+				eff.SetBinContent(k+1, l+1, e);
+				eff.SetBinError(k+1, l+1, std::sqrt(e*(1.-e)/n));
+			}
+		}
+		file->WriteTObject(&eff);
+	}
+
+	file->Close();
+	delete file;
+}
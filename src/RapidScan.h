@@ -0,0 +1,63 @@
+#ifndef RAPIDSCAN_H
+#define RAPIDSCAN_H
+
+#include <vector>
+
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TString.h"
+
+class RapidParam;
+
+//efficiencies of grids of cut thresholds found in a single pass over the selected events
+//
+//each scanned parameter is evaluated once per event and filled into a histogram whose bin edges are the thresholds
+//the efficiency of every threshold, and of every pair of thresholds on two parameters, is then found from the
+//cumulative counts, relative to all of the generated events
+class RapidScan {
+	public:
+		enum ScanType {
+			MIN, //keep events above the threshold
+			MAX  //keep events below the threshold
+		};
+
+		RapidScan() {}
+
+		~RapidScan();
+
+		//scan nSteps+1 thresholds evenly spaced from lo to hi
+		bool addVariable(RapidParam* param, TString type, double lo, double hi, int nSteps);
+
+		unsigned int nVariables() { return params_.size(); }
+		TString name(unsigned int i);
+
+		//fill with the current event, which has passed the selection
+		void fill();
+
+		//write the efficiency curves and grids to <outputName>_scan.root
+		void save(TString outputName, Long64_t nGenerated);
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidScan( const RapidScan& other );
+		RapidScan& operator=( const RapidScan& other );
+
+		//counts of events passing each threshold - index i is threshold i and the count of a bin includes those beyond it
+		std::vector<double> cumulate1D(unsigned int i);
+		std::vector<std::vector<double> > cumulate2D(unsigned int pair);
+		//the bins counted for each threshold of a parameter
+		void thresholdBins(unsigned int i, int threshold, int& first, int& last);
+
+		std::vector<RapidParam*> params_;
+		std::vector<ScanType> types_;
+
+		//distributions of each parameter and of each pair, in bins between the thresholds
+		std::vector<TH1D*> histos_;
+		std::vector<TH2D*> pairHistos_;
+		std::vector<unsigned int> pairFirst_;
+		std::vector<unsigned int> pairSecond_;
+
+		std::vector<double> values_;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "RapidServer.h"
+
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "TSystem.h"
+
+bool RapidServer::start() {
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(socketPath_.Length() >= static_cast<int>(sizeof(address.sun_path))) {
+		std::cout << "ERROR in RapidServer::start : socket path " << socketPath_ << " is too long." << std::endl;
+		return false;
+	}
+	strncpy(address.sun_path, socketPath_.Data(), sizeof(address.sun_path)-1);
+
+	socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(socket_<0) {
+		std::cout << "ERROR in RapidServer::start : failed to create socket." << std::endl;
+		return false;
+	}
+
+	//a socket left behind by a previous service would prevent binding
+	unlink(socketPath_.Data());
+	if(bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address))<0 || listen(socket_, 16)<0) {
+		std::cout << "ERROR in RapidServer::start : failed to listen on socket " << socketPath_ << "." << std::endl;
+		::close(socket_);
+		socket_ = -1;
+		return false;
+	}
+
+	//a client that disconnects early should not stop the service
+	signal(SIGPIPE, SIG_IGN);
+
+	std::cout << "INFO in RapidServer::start : listening for jobs on " << socketPath_ << std::endl;
+	return true;
+}
+
+void RapidServer::close() {
+	closeClient();
+	if(socket_>=0) {
+		::close(socket_);
+		socket_ = -1;
+		unlink(socketPath_.Data());
+	}
+}
+
+bool RapidServer::nextJob(std::vector<TString>& args, std::vector<TString>& settings) {
+	while(socket_>=0) {
+		closeClient();
+		client_ = accept(socket_, 0, 0);
+		if(client_<0) {
+			std::cout << "WARNING in RapidServer::nextJob : failed to accept connection." << std::endl;
+			continue;
+		}
+
+		TString line;
+		if(!readLine(line)) continue;
+		line = line.Strip(TString::kBoth);
+
+		if(line=="stop") {
+			std::cout << "INFO in RapidServer::nextJob : stop requested." << std::endl;
+			send("status 0\n");
+			closeClient();
+			return false;
+		}
+
+		args.clear();
+		TString token;
+		int from(0);
+		while(line.Tokenize(token, from, "[ \t]+")) {
+			args.push_back(token);
+		}
+
+		settings.clear();
+		TString setting;
+		while(readLine(setting)) {
+			setting = setting.Strip(TString::kBoth);
+			if(setting=="") break;
+			settings.push_back(setting);
+		}
+
+		if(args.empty()) {
+			send("status 1\n");
+			continue;
+		}
+
+		std::cout << "INFO in RapidServer::nextJob : received job " << line << std::endl;
+		return true;
+	}
+
+	return false;
+}
+
+void RapidServer::reply(int status, TString outputName) {
+	std::ostringstream out;
+	out << "status " << status << "\n";
+
+	if(outputName!="") {
+		//the client may be running in a different directory
+		if(!outputName.BeginsWith("/")) outputName.Prepend(TString(gSystem->WorkingDirectory())+"/");
+		out << "output " << outputName << "\n";
+		out << "hists " << outputName << "_hists.root\n";
+		out << "summary " << outputName << "_summary.json\n";
+
+		std::ifstream fin;
+		fin.open(outputName+"_summary.json", std::ifstream::in);
+		if(fin.good()) out << fin.rdbuf();
+		fin.close();
+	}
+
+	send(out.str().c_str());
+	closeClient();
+}
+
+bool RapidServer::readLine(TString& line) {
+	if(client_<0) return false;
+
+	size_t end = buffer_.find('\n');
+	while(end==std::string::npos) {
+		char data[4096];
+		ssize_t n = recv(client_, data, sizeof(data), 0);
+		if(n<=0) {
+			//the last line need not be terminated
+			if(buffer_.empty()) return false;
+			line = buffer_.c_str();
+			buffer_.clear();
+			return true;
+		}
+		buffer_.append(data, n);
+		end = buffer_.find('\n');
+	}
+
+	line = buffer_.substr(0, end).c_str();
+	buffer_.erase(0, end+1);
+	return true;
+}
+
+bool RapidServer::send(TString text) {
+	if(client_<0) return false;
+
+	const char* data = text.Data();
+	ssize_t remaining = text.Length();
+	while(remaining>0) {
+		ssize_t n = ::send(client_, data, remaining, 0);
+		if(n<=0) {
+			std::cout << "WARNING in RapidServer::send : client disconnected before the reply was sent." << std::endl;
+			return false;
+		}
+		data += n;
+		remaining -= n;
+	}
+	return true;
+}
+
+void RapidServer::closeClient() {
+	if(client_>=0) {
+		::close(client_);
+		client_ = -1;
+	}
+	buffer_.clear();
+}
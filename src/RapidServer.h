@@ -0,0 +1,42 @@
+#ifndef RAPIDSERVER_H
+#define RAPIDSERVER_H
+
+#include <string>
+#include <vector>
+
+#include "TString.h"
+
+//accepts generation jobs on a local Unix socket so that one process can run many short jobs
+//
+//each connection carries one job - the first line holds the arguments as they would be given on the
+//command line and any further lines, up to an empty line, are settings in the format of the config file
+//the reply gives the exit status of the job, the output files and the run summary
+class RapidServer {
+	public:
+		RapidServer(TString socketPath)
+			: socketPath_(socketPath), socket_(-1), client_(-1)
+			{}
+
+		~RapidServer() { close(); }
+
+		bool start();
+		void close();
+
+		//wait for the next job - returns false once the service has been asked to stop
+		bool nextJob(std::vector<TString>& args, std::vector<TString>& settings);
+		void reply(int status, TString outputName);
+
+	private:
+		bool readLine(TString& line);
+		bool send(TString text);
+		void closeClient();
+
+		TString socketPath_;
+		int socket_;
+		int client_;
+
+		//data received from the client that has not yet been read
+		std::string buffer_;
+};
+
+#endif
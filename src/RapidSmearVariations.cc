@@ -0,0 +1,153 @@
+#include "RapidSmearVariations.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "RapidDecay.h"
+#include "RapidParticle.h"
+
+void RapidSmearVariations::addVariation(RapidParticle* part, TString name, RapidMomentumSmear* momSmear, RapidIPSmear* ipSmear) {
+	unsigned int variation(0);
+	for( ; variation<names_.size(); ++variation) {
+		if(names_[variation]==name) break;
+	}
+	if(variation==names_.size()) {
+		names_.push_back(name);
+		for(unsigned int i=0; i<variedParts_.size(); ++i) {
+			momSmears_[i].push_back(0);
+			ipSmears_[i].push_back(0);
+		}
+	}
+
+	unsigned int index(0);
+	for( ; index<variedParts_.size(); ++index) {
+		if(variedParts_[index]==part) break;
+	}
+	if(index==variedParts_.size()) {
+		variedParts_.push_back(part);
+		momSmears_.push_back(std::vector<RapidMomentumSmear*>(names_.size(), 0));
+		ipSmears_.push_back(std::vector<RapidIPSmear*>(names_.size(), 0));
+		nominalMomSmears_.push_back(0);
+		nominalIPSmears_.push_back(0);
+	}
+
+	momSmears_[index][variation] = momSmear;
+	ipSmears_[index][variation] = ipSmear;
+}
+
+void RapidSmearVariations::setDecay(RapidDecay* decay, const std::vector<RapidParticle*>& parts) {
+	decay_ = decay;
+	parts_ = parts;
+
+	pSmeared_.resize(parts_.size());
+	ipSmeared_.resize(parts_.size());
+	sigmaIP_.resize(parts_.size());
+	minIPSmeared_.resize(parts_.size());
+	sigmaMinIP_.resize(parts_.size());
+
+	varied_.assign(parts_.size(), false);
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		varied_[i] = std::find(variedParts_.begin(), variedParts_.end(), parts_[i]) != variedParts_.end();
+	}
+}
+
+void RapidSmearVariations::saveRandomState(bool partial) {
+	//the variations themselves re-smear the decay
+	if(applying_) return;
+
+	partial_ = partial;
+	hasRandomState_ = copyRandomState(gRandom, &smearStart_);
+}
+
+void RapidSmearVariations::save() {
+	//the nominal smearing may have been set after the variations were declared
+	for(unsigned int i=0; i<variedParts_.size(); ++i) {
+		nominalMomSmears_[i] = variedParts_[i]->momentumSmearing();
+		nominalIPSmears_[i] = variedParts_[i]->ipSmearing();
+	}
+
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		RapidParticle* part = parts_[i];
+		pSmeared_[i] = part->getPSmeared();
+		ipSmeared_[i] = part->getIPSmeared();
+		sigmaIP_[i] = part->getSigmaIP();
+		minIPSmeared_[i] = part->getMinIPSmeared();
+		sigmaMinIP_[i] = part->getSigmaMinIP();
+	}
+
+	if(hasRandomState_) copyRandomState(gRandom, &afterNominal_);
+}
+
+bool RapidSmearVariations::apply(unsigned int i) {
+	if(!decay_) {
+		std::cout << "ERROR in RapidSmearVariations::apply : no decay to re-smear." << std::endl;
+		return false;
+	}
+
+	for(unsigned int j=0; j<variedParts_.size(); ++j) {
+		RapidMomentumSmear* momSmear = momSmears_[j][i] ? momSmears_[j][i] : nominalMomSmears_[j];
+		RapidIPSmear* ipSmear = ipSmears_[j][i] ? ipSmears_[j][i] : nominalIPSmears_[j];
+		setSmearing(j, momSmear, ipSmear);
+	}
+
+	//draw the same random numbers as the nominal smearing
+	if(hasRandomState_) copyRandomState(&smearStart_, gRandom);
+	applying_ = true;
+	decay_->smear(partial_);
+	applying_ = false;
+
+	//particles without a variation keep their nominal values even if the varied functions draw a different number of
+	//random numbers - run backwards so that the daughters are set before their mothers are reconstructed from them
+	for(int j=parts_.size()-1; j>=0; --j) {
+		RapidParticle* part = parts_[j];
+		if(part->nDaughters()>0) {
+			part->smearMomentum();
+		} else if(!varied_[j]) {
+			part->getPSmeared() = pSmeared_[j];
+			part->setIPSmeared(ipSmeared_[j]);
+			part->setIPSigma(sigmaIP_[j]);
+			part->setMinIPSmeared(minIPSmeared_[j]);
+			part->setMinIPSigma(sigmaMinIP_[j]);
+		}
+	}
+
+	return true;
+}
+
+void RapidSmearVariations::restore() {
+	for(unsigned int j=0; j<variedParts_.size(); ++j) {
+		setSmearing(j, nominalMomSmears_[j], nominalIPSmears_[j]);
+	}
+
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		RapidParticle* part = parts_[i];
+		part->getPSmeared() = pSmeared_[i];
+		part->setIPSmeared(ipSmeared_[i]);
+		part->setIPSigma(sigmaIP_[i]);
+		part->setMinIPSmeared(minIPSmeared_[i]);
+		part->setMinIPSigma(sigmaMinIP_[i]);
+	}
+
+	//the variations must not change the random numbers of the rest of the event
+	if(hasRandomState_) copyRandomState(&afterNominal_, gRandom);
+}
+
+void RapidSmearVariations::setSmearing(unsigned int part, RapidMomentumSmear* momSmear, RapidIPSmear* ipSmear) {
+	variedParts_[part]->setSmearing(momSmear);
+	variedParts_[part]->setSmearing(ipSmear);
+}
+
+bool RapidSmearVariations::copyRandomState(TRandom* from, TRandom* to) {
+	TRandom3* from3 = dynamic_cast<TRandom3*>(from);
+	TRandom3* to3 = dynamic_cast<TRandom3*>(to);
+	if(!from3 || !to3) {
+		if(!suppressRandomWarning_) {
+			std::cout << "WARNING in RapidSmearVariations::copyRandomState : the random number generator is not a TRandom3." << std::endl
+				  << "                                                  the variations will not be correlated with the nominal smearing." << std::endl;
+			suppressRandomWarning_ = true;
+		}
+		return false;
+	}
+	*to3 = *from3;
+	return true;
+}
@@ -0,0 +1,89 @@
+#ifndef RAPIDSMEARVARIATIONS_H
+#define RAPIDSMEARVARIATIONS_H
+
+#include <vector>
+
+#include "TLorentzVector.h"
+#include "TRandom3.h"
+#include "TString.h"
+
+class RapidDecay;
+class RapidIPSmear;
+class RapidMomentumSmear;
+class RapidParticle;
+
+//alternative smearing categories applied to the same true decay
+//
+//each variation is named after a smearing category and replaces the smearing of every particle that lists it
+//a variation replays the random numbers of the nominal smearing so that it is correlated with the nominal values
+//other particles keep their nominal smearing and the nominal smeared quantities and random numbers are restored after
+//the variations
+class RapidSmearVariations {
+	public:
+		RapidSmearVariations()
+			: decay_(0), partial_(false), applying_(false), hasRandomState_(false), suppressRandomWarning_(false)
+			{}
+
+		~RapidSmearVariations() {}
+
+		//smear a particle with the given functions in a variation - a missing function keeps the nominal one
+		void addVariation(RapidParticle* part, TString name, RapidMomentumSmear* momSmear, RapidIPSmear* ipSmear);
+
+		unsigned int nVariations() { return names_.size(); }
+		TString name(unsigned int i) { return names_[i]; }
+
+		//the decay to re-smear and all of its particles
+		void setDecay(RapidDecay* decay, const std::vector<RapidParticle*>& parts);
+
+		//keep the random numbers at the start of the nominal smearing of the current event
+		void saveRandomState(bool partial);
+		//keep the nominal smearing of the current event
+		void save();
+		//re-smear the current event with variation i
+		bool apply(unsigned int i);
+		//return to the nominal smearing of the current event
+		void restore();
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidSmearVariations( const RapidSmearVariations& other );
+		RapidSmearVariations& operator=( const RapidSmearVariations& other );
+
+		void setSmearing(unsigned int part, RapidMomentumSmear* momSmear, RapidIPSmear* ipSmear);
+		bool copyRandomState(TRandom* from, TRandom* to);
+
+		std::vector<TString> names_;
+
+		//particles with a variation and their smearing in each variation
+		std::vector<RapidParticle*> variedParts_;
+		std::vector<std::vector<RapidMomentumSmear*> > momSmears_;
+		std::vector<std::vector<RapidIPSmear*> > ipSmears_;
+
+		//nominal smearing of the varied particles
+		std::vector<RapidMomentumSmear*> nominalMomSmears_;
+		std::vector<RapidIPSmear*> nominalIPSmears_;
+
+		RapidDecay* decay_;
+		std::vector<RapidParticle*> parts_;
+
+		//nominal smeared quantities of every particle
+		std::vector<TLorentzVector> pSmeared_;
+		std::vector<double> ipSmeared_;
+		std::vector<double> sigmaIP_;
+		std::vector<double> minIPSmeared_;
+		std::vector<double> sigmaMinIP_;
+
+		//whether each particle has a variation
+		std::vector<bool> varied_;
+
+		//random numbers at the start of the nominal smearing and after it
+		TRandom3 smearStart_;
+		TRandom3 afterNominal_;
+		//whether the nominal smearing only redid part of the decay
+		bool partial_;
+		bool applying_;
+		bool hasRandomState_;
+		bool suppressRandomWarning_;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "RapidSummary.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "TSystem.h"
+
+void RapidSummary::clear() {
+	out_.str("");
+	out_.clear();
+	out_.precision(std::numeric_limits<double>::digits10);
+	empty_.clear();
+}
+
+void RapidSummary::beginObject(TString key) {
+	next(key);
+	out_ << "{";
+	empty_.push_back(true);
+}
+
+void RapidSummary::endObject() {
+	empty_.pop_back();
+	out_ << "\n" << std::string(2*empty_.size(), ' ') << "}";
+}
+
+void RapidSummary::beginArray(TString key) {
+	next(key);
+	out_ << "[";
+	empty_.push_back(true);
+}
+
+void RapidSummary::endArray() {
+	empty_.pop_back();
+	out_ << "]";
+}
+
+void RapidSummary::add(TString key, double value) {
+	next(key);
+	//JSON has no representation of inf or nan
+	if(std::isfinite(value)) out_ << value;
+	else out_ << "null";
+}
+
+void RapidSummary::add(TString key, Long64_t value) {
+	next(key);
+	out_ << value;
+}
+
+void RapidSummary::add(TString key, bool value) {
+	next(key);
+	out_ << (value ? "true" : "false");
+}
+
+void RapidSummary::add(TString key, TString value) {
+	next(key);
+	out_ << "\"" << escape(value) << "\"";
+}
+
+void RapidSummary::addValue(double value) {
+	add("", value);
+}
+
+void RapidSummary::addValue(Long64_t value) {
+	add("", value);
+}
+
+TString RapidSummary::json() {
+	return out_.str();
+}
+
+bool RapidSummary::write(TString fileName) {
+	//write to a temporary file and move it into place so readers never see a partial file
+	std::ofstream fout;
+	fout.open(fileName+".tmp", std::ofstream::out);
+	if(!fout.good()) {
+		std::cout << "ERROR in RapidSummary::write : failed to open file " << fileName << "." << std::endl;
+		return false;
+	}
+	fout << out_.str() << "\n";
+	fout.close();
+
+	if(gSystem->Rename(fileName+".tmp", fileName)!=0) {
+		std::cout << "ERROR in RapidSummary::write : failed to move summary to " << fileName << "." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void RapidSummary::next(TString key) {
+	if(empty_.empty()) return;
+
+	//arrays are written on a single line, objects with one entry per line
+	bool inArray = key.IsNull();
+	if(!empty_.back()) out_ << ",";
+	if(inArray) {
+		if(!empty_.back()) out_ << " ";
+	} else {
+		out_ << "\n" << std::string(2*empty_.size(), ' ') << "\"" << escape(key) << "\": ";
+	}
+	empty_.back() = false;
+}
+
+TString RapidSummary::escape(TString str) {
+	str.ReplaceAll("\\", "\\\\");
+	str.ReplaceAll("\"", "\\\"");
+	str.ReplaceAll("\n", "\\n");
+	str.ReplaceAll("\t", "\\t");
+	return str;
+}
@@ -0,0 +1,48 @@
+#ifndef RAPIDSUMMARY_H
+#define RAPIDSUMMARY_H
+
+#include <sstream>
+#include <vector>
+
+#include "TString.h"
+
+//builds a JSON summary of a run
+class RapidSummary {
+	public:
+		RapidSummary()
+			{ clear(); }
+
+		~RapidSummary() {}
+
+		void clear();
+
+		void beginObject(TString key="");
+		void endObject();
+		void beginArray(TString key="");
+		void endArray();
+
+		void add(TString key, double value);
+		void add(TString key, Long64_t value);
+		void add(TString key, int value) { add(key, static_cast<Long64_t>(value)); }
+		void add(TString key, bool value);
+		void add(TString key, TString value);
+		void add(TString key, const char* value) { add(key, TString(value)); }
+
+		//elements of an array
+		void addValue(double value);
+		void addValue(Long64_t value);
+
+		TString json();
+		bool write(TString fileName);
+
+	private:
+		void next(TString key);
+		static TString escape(TString str);
+
+		std::ostringstream out_;
+
+		//whether the current object or array has no entries yet
+		std::vector<bool> empty_;
+};
+
+#endif
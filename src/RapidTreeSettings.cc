@@ -0,0 +1,192 @@
+#include "RapidTreeSettings.h"
+
+#include <iostream>
+
+#include "TRegexp.h"
+
+bool RapidTreeSettings::setCompression(TString value) {
+	int from(0);
+	TString buffer;
+
+	if(!value.Tokenize(buffer,from," ")) {
+		std::cout << "ERROR in RapidTreeSettings::setCompression : no compression algorithm given." << std::endl;
+		return false;
+	}
+
+	int algorithm = algorithmFromString(buffer);
+	if(algorithm<0) {
+		std::cout << "ERROR in RapidTreeSettings::setCompression : unknown compression algorithm " << buffer << "." << std::endl
+			  << "                                             options are ZLIB, LZMA, LZ4, ZSTD or none." << std::endl;
+		return false;
+	}
+
+	int level(algorithm==0 ? 0 : 4);
+	if(algorithm!=0 && value.Tokenize(buffer,from," ")) {
+		level = buffer.Atoi();
+	}
+	if(level<0 || level>9) {
+		std::cout << "ERROR in RapidTreeSettings::setCompression : compression level must be between 0 and 9." << std::endl;
+		return false;
+	}
+
+	compression_ = 100*algorithm + level;
+	return true;
+}
+
+bool RapidTreeSettings::setBasketSize(TString value) {
+	int size = value.Atoi();
+	if(size<=0) {
+		std::cout << "ERROR in RapidTreeSettings::setBasketSize : basket size must be positive." << std::endl;
+		return false;
+	}
+	basketSize_ = size;
+	return true;
+}
+
+bool RapidTreeSettings::setAutoFlush(TString value) {
+	if(!value.IsFloat()) {
+		std::cout << "ERROR in RapidTreeSettings::setAutoFlush : auto-flush must be a number of entries (>0) or bytes (<0)." << std::endl;
+		return false;
+	}
+	autoFlush_ = value.Atoll();
+	return true;
+}
+
+bool RapidTreeSettings::setThreads(TString value) {
+	int nThreads = value.Atoi();
+	if(nThreads<0) {
+		std::cout << "ERROR in RapidTreeSettings::setThreads : number of threads must not be negative." << std::endl;
+		return false;
+	}
+	nThreads_ = nThreads;
+	return true;
+}
+
+bool RapidTreeSettings::addStorage(TString value) {
+	int from(0);
+	TString buffer;
+	StorageType type;
+	int nBits(0);
+
+	if(!value.Tokenize(buffer,from," ")) {
+		std::cout << "ERROR in RapidTreeSettings::addStorage : no storage type given." << std::endl;
+		return false;
+	}
+
+	if(buffer=="double") {
+		type = RapidTreeSettings::DOUBLE;
+	} else if(buffer=="float") {
+		type = RapidTreeSettings::FLOAT;
+	} else if(buffer=="truncated") {
+		type = RapidTreeSettings::TRUNCATED;
+		if(value.Tokenize(buffer,from," ")) {
+			nBits = buffer.Atoi();
+		}
+		if(nBits<2 || nBits>14) {
+			std::cout << "ERROR in RapidTreeSettings::addStorage : truncated storage requires a number of mantissa bits between 2 and 14." << std::endl;
+			return false;
+		}
+	} else {
+		std::cout << "ERROR in RapidTreeSettings::addStorage : unknown storage type " << buffer << "." << std::endl
+			  << "                                         options are double, float or truncated." << std::endl;
+		return false;
+	}
+
+	bool found(false);
+	while(value.Tokenize(buffer,from," ")) {
+		storagePatterns_.push_back(buffer);
+		storageTypes_.push_back(type);
+		storageBits_.push_back(nBits);
+		found = true;
+	}
+
+	//no patterns given so apply to all variables
+	if(!found) {
+		storagePatterns_.push_back("*");
+		storageTypes_.push_back(type);
+		storageBits_.push_back(nBits);
+	}
+
+	return true;
+}
+
+bool RapidTreeSettings::setMaxFileSize(TString value) {
+	double size = value.Atof();
+	if(size<=0.) {
+		std::cout << "ERROR in RapidTreeSettings::setMaxFileSize : maximum file size must be positive." << std::endl;
+		return false;
+	}
+	//given in MB
+	maxFileSize_ = static_cast<Long64_t>(size*1.e6);
+	return true;
+}
+
+bool RapidTreeSettings::setMaxFileEntries(TString value) {
+	Long64_t entries = value.Atoll();
+	if(entries<=0) {
+		std::cout << "ERROR in RapidTreeSettings::setMaxFileEntries : maximum number of entries per file must be positive." << std::endl;
+		return false;
+	}
+	maxFileEntries_ = entries;
+	return true;
+}
+
+TString RapidTreeSettings::leafList(TString varName) {
+	//floats are stored as Double32_t so that the branch can point directly at the double buffer
+	TString leaf = varName;
+
+	int rule = findStorageRule(varName);
+	if(rule<0) {
+		leaf += "/D";
+		return leaf;
+	}
+
+	switch(storageTypes_[rule]) {
+		case RapidTreeSettings::FLOAT:
+			leaf += "/d";
+			break;
+		case RapidTreeSettings::TRUNCATED:
+			leaf += "/d[0,0,";
+			leaf += storageBits_[rule];
+			leaf += "]";
+			break;
+		case RapidTreeSettings::DOUBLE:
+		default:
+			leaf += "/D";
+	}
+
+	return leaf;
+}
+
+int RapidTreeSettings::findStorageRule(TString varName) {
+	//the last matching rule takes precedence
+	for(int i=storagePatterns_.size()-1; i>=0; --i) {//don't change to unsigned - needs to hit -1 to break loop
+		TRegexp regexp(storagePatterns_[i], kTRUE);
+		Ssiz_t len(0);
+		if(regexp.Index(varName,&len)==0 && len==varName.Length()) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int RapidTreeSettings::algorithmFromString(TString str) {
+	//codes follow ROOT's compression algorithm enumeration
+	str.ToUpper();
+	if(str=="NONE") {
+		return 0;
+	} else if(str=="ZLIB") {
+		return 1;
+	} else if(str=="LZMA") {
+		return 2;
+	} else if(str=="LZ4") {
+		return 4;
+	} else if(str=="ZSTD") {
+		return 5;
+	}
+	return -1;
+}
+
+bool RapidTreeSettings::isDefault() {
+	return compression_==-1 && basketSize_==32000 && autoFlush_==0 && nThreads_==0 && !rollover() && storagePatterns_.empty();
+}
@@ -0,0 +1,67 @@
+#ifndef RAPIDTREESETTINGS_H
+#define RAPIDTREESETTINGS_H
+
+#include <vector>
+
+#include "TString.h"
+
+class RapidTreeSettings {
+	public:
+		enum StorageType {
+			DOUBLE,   //64 bit double
+			FLOAT,    //32 bit float
+			TRUNCATED //float with a truncated mantissa
+		};
+
+		RapidTreeSettings()
+			: compression_(-1), basketSize_(32000), autoFlush_(0), nThreads_(0),
+			  maxFileSize_(0), maxFileEntries_(0)
+			{}
+
+		~RapidTreeSettings() {}
+
+		bool setCompression(TString value);
+		bool setBasketSize(TString value);
+		bool setAutoFlush(TString value);
+		bool setThreads(TString value);
+		bool addStorage(TString value);
+		bool setMaxFileSize(TString value);
+		bool setMaxFileEntries(TString value);
+
+		//ROOT compression setting (100*algorithm + level) or -1 to use the ROOT default
+		int compression() { return compression_; }
+		int basketSize() { return basketSize_; }
+		//entries (>0) or bytes (<0) between flushes or 0 to use the ROOT default
+		Long64_t autoFlush() { return autoFlush_; }
+		int nThreads() { return nThreads_; }
+
+		//limits at which to roll over to a new output file or 0 for no limit
+		Long64_t maxFileSize() { return maxFileSize_; }
+		Long64_t maxFileEntries() { return maxFileEntries_; }
+		bool rollover() { return maxFileSize_>0 || maxFileEntries_>0; }
+
+		TString leafList(TString varName);
+
+		//whether every setting has its default value
+		bool isDefault();
+
+	private:
+		static int algorithmFromString(TString str);
+
+		int findStorageRule(TString varName);
+
+		int compression_;
+		int basketSize_;
+		Long64_t autoFlush_;
+		int nThreads_;
+
+		Long64_t maxFileSize_;
+		Long64_t maxFileEntries_;
+
+		//storage rules - the last rule matching a variable is used
+		std::vector<TString> storagePatterns_;
+		std::vector<StorageType> storageTypes_;
+		std::vector<int> storageBits_;
+};
+
+#endif
@@ -0,0 +1,233 @@
+#include "RapidTruthCache.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "TLorentzVector.h"
+#include "TRandom3.h"
+
+#include "RapidDecay.h"
+#include "RapidParticle.h"
+#include "RapidVertex.h"
+
+namespace {
+	const char magic[8] = {'R','A','P','I','D','T','R','C'};
+
+	//event number, truth event number in two halves, seed, PV tracks and number of pileup vertices
+	const unsigned int nHeader = 6;
+}
+
+RapidTruthCache::~RapidTruthCache() {
+	endEvent();
+	if(fout_.is_open()) fout_.close();
+	if(fin_.is_open()) fin_.close();
+	if(responseRng_) delete responseRng_;
+}
+
+bool RapidTruthCache::create(TString fileName) {
+	fout_.open(fileName.Data(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!fout_.is_open()) {
+		std::cout << "ERROR in RapidTruthCache::create : failed to create file " << fileName << "." << std::endl;
+		return false;
+	}
+	writing_ = true;
+
+	//the particles are recorded so that a replay can check that it has the same decay
+	UInt_t nParts = parts_.size();
+	fout_.write(magic, sizeof(magic));
+	fout_.write(reinterpret_cast<const char*>(&nParts), sizeof(nParts));
+	nValues_ = 3;
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		Int_t id = parts_[i]->id();
+		fout_.write(reinterpret_cast<const char*>(&id), sizeof(id));
+		nValues_ += hasDecayVertex(i) ? 7 : 4;
+	}
+	if(!fout_.good()) {
+		std::cout << "ERROR in RapidTruthCache::create : failed to write to file " << fileName << "." << std::endl;
+		return false;
+	}
+
+	responseRng_ = new TRandom3();
+	std::cout << "INFO in RapidTruthCache::create : writing the true decays to " << fileName << "." << std::endl;
+	return true;
+}
+
+bool RapidTruthCache::open(TString fileName) {
+	fin_.open(fileName.Data(), std::ios::in | std::ios::binary);
+	if(!fin_.is_open()) {
+		std::cout << "ERROR in RapidTruthCache::open : failed to open file " << fileName << "." << std::endl;
+		return false;
+	}
+
+	char fileMagic[8];
+	UInt_t nParts(0);
+	fin_.read(fileMagic, sizeof(fileMagic));
+	fin_.read(reinterpret_cast<char*>(&nParts), sizeof(nParts));
+	if(!fin_ || std::memcmp(fileMagic, magic, sizeof(magic))!=0) {
+		std::cout << "ERROR in RapidTruthCache::open : file " << fileName << " is not a cache of true decays." << std::endl;
+		return false;
+	}
+	if(nParts!=parts_.size()) {
+		std::cout << "ERROR in RapidTruthCache::open : cache " << fileName << " was written for a decay of " << nParts << " particles but this decay has " << parts_.size() << "." << std::endl;
+		return false;
+	}
+
+	nValues_ = 3;
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		Int_t id(0);
+		fin_.read(reinterpret_cast<char*>(&id), sizeof(id));
+		if(id!=parts_[i]->id()) {
+			std::cout << "ERROR in RapidTruthCache::open : particle " << i << " of cache " << fileName << " has ID " << id << " but " << parts_[i]->name() << " has ID " << parts_[i]->id() << "." << std::endl;
+			return false;
+		}
+		nValues_ += hasDecayVertex(i) ? 7 : 4;
+	}
+
+	responseRng_ = new TRandom3();
+	std::cout << "INFO in RapidTruthCache::open : replaying the true decays in " << fileName << "." << std::endl;
+	return true;
+}
+
+bool RapidTruthCache::write(int nEvent, Long64_t nTruthEvent) {
+	if(!writing_) {
+		std::cout << "ERROR in RapidTruthCache::write : the cache was not created for writing." << std::endl;
+		return false;
+	}
+
+	//a seed of 0 would be taken from the clock
+	UInt_t seed = 1 + gRandom->Integer(4294967294u);
+
+	std::vector<RapidVertex>& pileup = decay_->pileupVertices();
+	RapidVertex* pv = parts_[0]->getOriginVertex();
+
+	header_.clear();
+	header_.push_back(nEvent);
+	header_.push_back(static_cast<ULong64_t>(nTruthEvent) & 0xffffffffu);
+	header_.push_back(static_cast<ULong64_t>(nTruthEvent) >> 32);
+	header_.push_back(seed);
+	header_.push_back(pv->ntracks());
+	header_.push_back(pileup.size());
+
+	values_.clear();
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		TLorentzVector& p = parts_[i]->getP();
+		values_.push_back(p.Px());
+		values_.push_back(p.Py());
+		values_.push_back(p.Pz());
+		values_.push_back(p.E());
+	}
+	ROOT::Math::XYZPoint point = pv->getVertex(true);
+	values_.push_back(point.X());
+	values_.push_back(point.Y());
+	values_.push_back(point.Z());
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		if(!hasDecayVertex(i)) continue;
+		point = parts_[i]->getDecayVertex()->getVertex(true);
+		values_.push_back(point.X());
+		values_.push_back(point.Y());
+		values_.push_back(point.Z());
+	}
+
+	pileupValues_.clear();
+	pileupTracks_.clear();
+	for(unsigned int i=0; i<pileup.size(); ++i) {
+		point = pileup[i].getVertex(true);
+		pileupValues_.push_back(point.X());
+		pileupValues_.push_back(point.Y());
+		pileupValues_.push_back(point.Z());
+		pileupTracks_.push_back(pileup[i].ntracks());
+	}
+
+	fout_.write(reinterpret_cast<const char*>(&header_[0]), nHeader*sizeof(UInt_t));
+	fout_.write(reinterpret_cast<const char*>(&values_[0]), nValues_*sizeof(double));
+	if(!pileup.empty()) {
+		fout_.write(reinterpret_cast<const char*>(&pileupTracks_[0]), pileupTracks_.size()*sizeof(UInt_t));
+		fout_.write(reinterpret_cast<const char*>(&pileupValues_[0]), pileupValues_.size()*sizeof(double));
+	}
+	if(!fout_.good()) {
+		std::cout << "ERROR in RapidTruthCache::write : failed to write event " << nRecords_ << " to the cache." << std::endl;
+		return false;
+	}
+
+	++nRecords_;
+	startResponse(seed);
+	return true;
+}
+
+bool RapidTruthCache::read() {
+	header_.resize(nHeader);
+	if(!fin_.read(reinterpret_cast<char*>(&header_[0]), nHeader*sizeof(UInt_t))) {
+		atEnd_ = true;
+		return false;
+	}
+
+	UInt_t nPileup = header_[5];
+	values_.resize(nValues_);
+	pileupTracks_.resize(nPileup);
+	pileupValues_.resize(3*nPileup);
+	fin_.read(reinterpret_cast<char*>(&values_[0]), nValues_*sizeof(double));
+	if(nPileup>0) {
+		fin_.read(reinterpret_cast<char*>(&pileupTracks_[0]), nPileup*sizeof(UInt_t));
+		fin_.read(reinterpret_cast<char*>(&pileupValues_[0]), 3*nPileup*sizeof(double));
+	}
+	if(!fin_) {
+		std::cout << "ERROR in RapidTruthCache::read : the cache ends part way through event " << nRecords_ << "." << std::endl;
+		atEnd_ = true;
+		truncated_ = true;
+		return false;
+	}
+
+	unsigned int k(0);
+	for(unsigned int i=0; i<parts_.size(); ++i, k+=4) {
+		TLorentzVector p;
+		p.SetPxPyPzE(values_[k], values_[k+1], values_[k+2], values_[k+3]);
+		parts_[i]->setP(p);
+	}
+
+	//mothers come before their daughters so the PV is set before any decay vertex
+	RapidVertex* pv = parts_[0]->getOriginVertex();
+	pv->setXYZ(values_[k], values_[k+1], values_[k+2]);
+	pv->setNtracks(header_[4]);
+	k+=3;
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		if(!hasDecayVertex(i)) continue;
+		parts_[i]->getDecayVertex()->setXYZ(values_[k], values_[k+1], values_[k+2]);
+		k+=3;
+	}
+
+	std::vector<RapidVertex>& pileup = decay_->pileupVertices();
+	pileup.clear();
+	for(unsigned int i=0; i<nPileup; ++i) {
+		RapidVertex vtx(pileupValues_[3*i], pileupValues_[3*i+1], pileupValues_[3*i+2]);
+		vtx.setNtracks(pileupTracks_[i]);
+		pileup.push_back(vtx);
+	}
+
+	nEvent_ = header_[0];
+	nTruthEvent_ = static_cast<Long64_t>(static_cast<ULong64_t>(header_[2])<<32 | header_[1]);
+
+	++nRecords_;
+	startResponse(header_[3]);
+	return true;
+}
+
+bool RapidTruthCache::hasDecayVertex(unsigned int i) {
+	//only particles that decay in the model have their decay vertex generated and smeared
+	return parts_[i]->nDaughters()>0 && parts_[i]->ctau()>0;
+}
+
+void RapidTruthCache::endEvent() {
+	if(!generatorRng_) return;
+	gRandom = generatorRng_;
+	generatorRng_ = 0;
+}
+
+void RapidTruthCache::startResponse(UInt_t seed) {
+	endEvent();
+	responseRng_->SetSeed(seed);
+	generatorRng_ = gRandom;
+	gRandom = responseRng_;
+
+	//everything after the true decay is drawn from the stream of the event, including the vertex smearing
+	decay_->smearAll();
+}
@@ -0,0 +1,83 @@
+#ifndef RAPIDTRUTHCACHE_H
+#define RAPIDTRUTHCACHE_H
+
+#include <fstream>
+#include <vector>
+
+#include "TRandom.h"
+#include "TString.h"
+
+class RapidDecay;
+class RapidParticle;
+
+//binary cache of the true decays of a run so that the detector response and selection can be replayed
+//
+//each record holds the true momenta of every particle, the PV, the decay vertices and the pileup vertices of an event
+//the detector response of each event is drawn from its own random number stream, seeded from the record, so a replay
+//with the same detector settings reproduces the run that wrote the cache exactly
+class RapidTruthCache {
+	public:
+		RapidTruthCache(RapidDecay* decay, const std::vector<RapidParticle*>& parts)
+			: decay_(decay), parts_(parts), writing_(false), atEnd_(false), truncated_(false), nRecords_(0),
+			  nEvent_(0), nTruthEvent_(0), nValues_(0), generatorRng_(0), responseRng_(0)
+			{}
+
+		~RapidTruthCache();
+
+		//start a new cache or open one to replay
+		bool create(TString fileName);
+		bool open(TString fileName);
+
+		//record the current event and start its detector response
+		bool write(int nEvent, Long64_t nTruthEvent);
+		//load the next event and start its detector response - false once the cache is exhausted
+		bool read();
+		//return to the random numbers of the generator once the response of the event is complete
+		void endEvent();
+
+		//numbering of the replayed event in the run that wrote the cache
+		int nEvent() { return nEvent_; }
+		Long64_t nTruthEvent() { return nTruthEvent_; }
+
+		bool atEnd() { return atEnd_; }
+		//whether the cache ended part way through a record
+		bool truncated() { return truncated_; }
+		Long64_t nRecords() { return nRecords_; }
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidTruthCache( const RapidTruthCache& other );
+		RapidTruthCache& operator=( const RapidTruthCache& other );
+
+		bool hasDecayVertex(unsigned int i);
+		void startResponse(UInt_t seed);
+
+		RapidDecay* decay_;
+		std::vector<RapidParticle*> parts_;
+
+		std::ofstream fout_;
+		std::ifstream fin_;
+		bool writing_;
+		bool atEnd_;
+		bool truncated_;
+		Long64_t nRecords_;
+
+		int nEvent_;
+		Long64_t nTruthEvent_;
+
+		//true values of the current record - momenta, PV and decay vertices of the long-lived particles
+		std::vector<double> values_;
+		unsigned int nValues_;
+		//integers of the current record - event number, truth event number in two halves, seed, PV tracks and number of
+		//pileup vertices
+		std::vector<UInt_t> header_;
+		//pileup vertices of the current record - positions and numbers of tracks
+		std::vector<double> pileupValues_;
+		std::vector<UInt_t> pileupTracks_;
+
+		//generator random numbers, set aside during the detector response
+		TRandom* generatorRng_;
+		TRandom* responseRng_;
+};
+
+#endif
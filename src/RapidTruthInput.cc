@@ -0,0 +1,31 @@
+#include "RapidTruthInput.h"
+
+#include "RapidParticle.h"
+#include "RapidTruthInputHepMC.h"
+#include "RapidTruthInputTree.h"
+
+RapidTruthInput* RapidTruthInput::open(TString fileName, const std::vector<RapidParticle*>& parts) {
+	RapidTruthInput* input(0);
+	if(fileName.EndsWith(".root") || fileName.Contains(".root:")) {
+		input = new RapidTruthInputTree(parts);
+	} else {
+		input = new RapidTruthInputHepMC(parts);
+	}
+
+	if(!input->setup(fileName)) {
+		delete input;
+		return 0;
+	}
+	return input;
+}
+
+void RapidTruthInput::setPV(double x, double y, double z) {
+	parts_[0]->getOriginVertex()->setXYZ(x,y,z);
+}
+
+void RapidTruthInput::setDecayVertex(unsigned int i, double x, double y, double z) {
+	RapidParticle* part = parts_[i];
+	if(part->ctau()>0) {
+		part->getDecayVertex()->setXYZ(x,y,z);
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef RAPIDTRUTHINPUT_H
+#define RAPIDTRUTHINPUT_H
+
+#include <vector>
+
+#include "TString.h"
+
+class RapidParticle;
+
+//true decays read from an external sample in place of generating them
+//
+//the momenta of every particle of the decay are read, together with the PV and the decay vertices when the sample has
+//them, so that only the pileup and the detector response need to be simulated
+class RapidTruthInput {
+	public:
+		RapidTruthInput(const std::vector<RapidParticle*>& parts)
+			: parts_(parts), hasVertices_(false), atEnd_(false), nRead_(0)
+			{}
+
+		virtual ~RapidTruthInput() {}
+
+		//a tree in a ROOT file, given as <file>.root or <file>.root:<tree>, or else a HepMC3 ASCII file
+		static RapidTruthInput* open(TString fileName, const std::vector<RapidParticle*>& parts);
+
+		//set the true momenta and vertices of the particles to those of the next decay - false once the sample is exhausted
+		virtual bool next()=0;
+
+		//whether the decay vertices of the current decay were read or must be generated from the lifetimes
+		bool hasVertices() { return hasVertices_; }
+
+		bool atEnd() { return atEnd_; }
+		Long64_t nRead() { return nRead_; }
+
+	protected:
+		virtual bool setup(TString fileName)=0;
+
+		void setPV(double x, double y, double z);
+		//only long-lived particles have a decay vertex of their own
+		void setDecayVertex(unsigned int i, double x, double y, double z);
+
+		std::vector<RapidParticle*> parts_;
+
+		bool hasVertices_;
+		bool atEnd_;
+		Long64_t nRead_;
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidTruthInput( const RapidTruthInput& other );
+		RapidTruthInput& operator=( const RapidTruthInput& other );
+};
+
+#endif
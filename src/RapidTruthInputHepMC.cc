@@ -0,0 +1,315 @@
+#include "RapidTruthInputHepMC.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "RapidParticle.h"
+
+bool RapidTruthInputHepMC::next() {
+	while(readEvent()) {
+		if(!findDecay()) {
+			++nSkipped_;
+			continue;
+		}
+
+		for(unsigned int i=0; i<parts_.size(); ++i) {
+			parts_[i]->setP(momenta_[match_[i]]);
+		}
+
+		//mothers come before their daughters so the PV is set before any decay vertex
+		TLorentzVector pv = productionPosition(headId_);
+		setPV(pv.X(), pv.Y(), pv.Z());
+
+		hasVertices_ = true;
+		for(unsigned int i=0; i<parts_.size(); ++i) {
+			if(parts_[i]->nDaughters()==0 || parts_[i]->ctau()<=0) continue;
+			int id = match_[i];
+			if(!hasEndPosition_[id]) {
+				hasVertices_ = false;
+				continue;
+			}
+			setDecayVertex(i, endPositions_[id].X(), endPositions_[id].Y(), endPositions_[id].Z());
+		}
+
+		if(!hasVertices_ && !suppressVertexWarning_) {
+			std::cout << "WARNING in RapidTruthInputHepMC::next : decay vertices are missing for some events." << std::endl
+				  << "                                        they will be generated from the lifetimes of the particles." << std::endl
+				  << "                                        further warnings will be suppressed." << std::endl;
+			suppressVertexWarning_ = true;
+		}
+
+		++nRead_;
+		return true;
+	}
+
+	atEnd_ = true;
+	if(nSkipped_>0) {
+		std::cout << "INFO in RapidTruthInputHepMC::next : skipped " << nSkipped_ << " events that did not contain the decay." << std::endl;
+	}
+	return false;
+}
+
+bool RapidTruthInputHepMC::setup(TString fileName) {
+	file_.open(fileName.Data());
+	if(!file_.is_open()) {
+		std::cout << "ERROR in RapidTruthInputHepMC::setup : failed to open file " << fileName << "." << std::endl;
+		return false;
+	}
+
+	bool found(false);
+	std::string line;
+	while(std::getline(file_, line)) {
+		if(line.find("Asciiv3-START_EVENT_LISTING")!=std::string::npos) {
+			found = true;
+			break;
+		}
+	}
+	if(!found) {
+		std::cout << "ERROR in RapidTruthInputHepMC::setup : file " << fileName << " is not in the HepMC3 ASCII format." << std::endl;
+		return false;
+	}
+
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		daughterIndices_.push_back(std::vector<unsigned int>());
+		for(RapidParticle* daug=parts_[i]->daughter(0); daug!=0; daug=daug->next()) {
+			daughterIndices_[i].push_back(std::find(parts_.begin(), parts_.end(), daug) - parts_.begin());
+		}
+	}
+	match_.assign(parts_.size(), 0);
+
+	std::cout << "INFO in RapidTruthInputHepMC::setup : reading true decays from HepMC3 file " << fileName << "." << std::endl;
+	return true;
+}
+
+bool RapidTruthInputHepMC::readEvent() {
+	pdg_.assign(1, 0);
+	parent_.assign(1, 0);
+	momenta_.assign(1, TLorentzVector());
+	vertexIn_.assign(1, std::vector<int>());
+	hasVertexPosition_.assign(1, false);
+	vertexPositions_.assign(1, TLorentzVector());
+	eventPosition_.SetXYZT(0., 0., 0., 0.);
+
+	bool inEvent(false);
+	std::string line;
+	while(true) {
+		if(!pendingLine_.empty()) {
+			line = pendingLine_;
+			pendingLine_.clear();
+		} else if(!std::getline(file_, line)) {
+			break;
+		}
+
+		std::istringstream stream(line);
+		std::string type;
+		if(!(stream >> type)) continue;
+
+		if(type=="E") {
+			//the event ends at the start of the next one
+			if(inEvent) {
+				pendingLine_ = line;
+				break;
+			}
+			inEvent = true;
+			int number(0), nVertices(0), nParticles(0);
+			stream >> number >> nVertices >> nParticles;
+			readPosition(stream, eventPosition_);
+		} else if(type.compare(0, 7, "HepMC::")==0) {
+			//the end of the listing
+			if(inEvent) break;
+		} else if(!inEvent) {
+			continue;
+		} else if(type=="U") {
+			readUnits(stream);
+		} else if(type=="P") {
+			readParticle(stream);
+		} else if(type=="V") {
+			readVertex(stream);
+		}
+	}
+
+	if(!inEvent) return false;
+
+	//the units of the event are given after the position of its root vertex
+	eventPosition_.SetXYZT(eventPosition_.X()*lengthUnit_, eventPosition_.Y()*lengthUnit_, eventPosition_.Z()*lengthUnit_, eventPosition_.T()*lengthUnit_);
+	findChildren();
+	return true;
+}
+
+void RapidTruthInputHepMC::readUnits(std::istringstream& line) {
+	std::string momentum, length;
+	line >> momentum >> length;
+	momentumUnit_ = momentum=="MEV" ? 1e-3 : 1.;
+	lengthUnit_ = length=="CM" ? 10. : 1.;
+}
+
+void RapidTruthInputHepMC::readParticle(std::istringstream& line) {
+	int id(0), parent(0), pdg(0);
+	double px(0.), py(0.), pz(0.), e(0.);
+	line >> id >> parent >> pdg >> px >> py >> pz >> e;
+	if(id<=0) return;
+
+	if(id>=static_cast<int>(pdg_.size())) {
+		pdg_.resize(id+1, 0);
+		parent_.resize(id+1, 0);
+		momenta_.resize(id+1);
+	}
+	pdg_[id] = pdg;
+	parent_[id] = parent;
+	momenta_[id].SetPxPyPzE(px*momentumUnit_, py*momentumUnit_, pz*momentumUnit_, e*momentumUnit_);
+}
+
+void RapidTruthInputHepMC::readVertex(std::istringstream& line) {
+	int id(0), status(0);
+	std::string in;
+	line >> id >> status >> in;
+	if(id>=0) return;
+
+	unsigned int index = -id;
+	if(index>=vertexIn_.size()) {
+		vertexIn_.resize(index+1);
+		hasVertexPosition_.resize(index+1, false);
+		vertexPositions_.resize(index+1);
+	}
+
+	//incoming particles are listed as [1,2,...]
+	std::replace(in.begin(), in.end(), '[', ' ');
+	std::replace(in.begin(), in.end(), ']', ' ');
+	std::replace(in.begin(), in.end(), ',', ' ');
+	std::istringstream ids(in);
+	int particle(0);
+	while(ids >> particle) {
+		vertexIn_[index].push_back(particle);
+	}
+
+	TLorentzVector pos;
+	if(readPosition(line, pos)) {
+		hasVertexPosition_[index] = true;
+		vertexPositions_[index].SetXYZT(pos.X()*lengthUnit_, pos.Y()*lengthUnit_, pos.Z()*lengthUnit_, pos.T()*lengthUnit_);
+	}
+}
+
+bool RapidTruthInputHepMC::readPosition(std::istringstream& line, TLorentzVector& pos) {
+	std::string at;
+	double x(0.), y(0.), z(0.), t(0.);
+	if(!(line >> at) || at!="@") return false;
+	if(!(line >> x >> y >> z >> t)) return false;
+	pos.SetXYZT(x, y, z, t);
+	return true;
+}
+
+void RapidTruthInputHepMC::findChildren() {
+	int nParticles = pdg_.size();
+	children_.assign(nParticles, std::vector<int>());
+	hasEndPosition_.assign(nParticles, false);
+	endPositions_.assign(nParticles, TLorentzVector());
+
+	for(unsigned int v=1; v<vertexIn_.size(); ++v) {
+		if(!hasVertexPosition_[v]) continue;
+		for(unsigned int k=0; k<vertexIn_[v].size(); ++k) {
+			int in = vertexIn_[v][k];
+			if(in<=0 || in>=nParticles) continue;
+			hasEndPosition_[in] = true;
+			endPositions_[in] = vertexPositions_[v];
+		}
+	}
+
+	//a particle is produced either in a vertex or, when its vertex has a single incoming particle, by that particle
+	for(int j=1; j<nParticles; ++j) {
+		int parent = parent_[j];
+		if(parent>0 && parent<nParticles) {
+			children_[parent].push_back(j);
+		} else if(parent<0 && -parent<static_cast<int>(vertexIn_.size())) {
+			for(unsigned int k=0; k<vertexIn_[-parent].size(); ++k) {
+				int in = vertexIn_[-parent][k];
+				if(in>0 && in<nParticles) children_[in].push_back(j);
+			}
+		}
+	}
+}
+
+bool RapidTruthInputHepMC::findDecay() {
+	int id = parts_[0]->id();
+	for(unsigned int j=1; j<pdg_.size(); ++j) {
+		if(std::abs(pdg_[j])!=std::abs(id)) continue;
+
+		//a parent that mixes is matched to the decay of its last copy
+		int last = lastCopy(j);
+		if(std::abs(pdg_[last])!=std::abs(id)) continue;
+		int sign = pdg_[last]==id ? 1 : -1;
+
+		if(matchDecay(j, 0, sign)) {
+			headId_ = j;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool RapidTruthInputHepMC::matchDecay(int id, unsigned int index, int sign) {
+	if(parts_[index]->nDaughters()==0) {
+		match_[index] = id;
+		return true;
+	}
+
+	id = lastCopy(id);
+	match_[index] = id;
+
+	std::vector<bool> used(children_[id].size(), false);
+	return matchDaughters(children_[id], used, index, 0, sign);
+}
+
+bool RapidTruthInputHepMC::matchDaughters(const std::vector<int>& children, std::vector<bool>& used, unsigned int index, unsigned int daughter, int sign) {
+	const std::vector<unsigned int>& daughters = daughterIndices_[index];
+	if(daughter==daughters.size()) {
+		//anything left over must be radiated photons
+		for(unsigned int k=0; k<children.size(); ++k) {
+			if(!used[k] && pdg_[children[k]]!=22) return false;
+		}
+		return true;
+	}
+
+	RapidParticle* part = parts_[daughters[daughter]];
+	for(unsigned int k=0; k<children.size(); ++k) {
+		if(used[k]) continue;
+
+		//neutral particles may be their own antiparticle
+		int pdg = pdg_[children[k]];
+		if(pdg!=sign*part->id() && (part->charge()!=0. || pdg!=part->id())) continue;
+
+		//identical particles may decay differently so each assignment is tried in turn
+		used[k] = true;
+		if(matchDecay(children[k], daughters[daughter], sign) && matchDaughters(children, used, index, daughter+1, sign)) return true;
+		used[k] = false;
+	}
+	return false;
+}
+
+int RapidTruthInputHepMC::lastCopy(int id) {
+	//limited to the size of the event in case of a malformed event
+	for(unsigned int n=0; n<pdg_.size() && children_[id].size()==1; ++n) {
+		id = children_[id][0];
+	}
+	return id;
+}
+
+TLorentzVector RapidTruthInputHepMC::productionPosition(int id) {
+	//vertex positions are absolute and a vertex without a position is at the position of the vertex its first incoming
+	//particle was produced in, or at the root vertex of the event
+	for(unsigned int n=0; n<pdg_.size(); ++n) {
+		int parent = parent_[id];
+		if(parent>0 && parent<static_cast<int>(pdg_.size())) {
+			if(hasEndPosition_[parent]) return endPositions_[parent];
+			id = parent;
+		} else if(parent<0 && -parent<static_cast<int>(vertexIn_.size())) {
+			if(hasVertexPosition_[-parent]) return vertexPositions_[-parent];
+			if(vertexIn_[-parent].empty()) break;
+			id = vertexIn_[-parent][0];
+			if(id<=0 || id>=static_cast<int>(pdg_.size())) break;
+		} else {
+			break;
+		}
+	}
+	return eventPosition_;
+}
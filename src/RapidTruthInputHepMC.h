@@ -0,0 +1,84 @@
+#ifndef RAPIDTRUTHINPUTHEPMC_H
+#define RAPIDTRUTHINPUTHEPMC_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TLorentzVector.h"
+
+#include "RapidTruthInput.h"
+
+//true decays read from a HepMC3 ASCII file
+//
+//the file is read one event at a time and the first particle of each event whose decay tree matches the decay, or its
+//charge conjugate, is used - events without the decay are skipped
+//copies of a particle made by the generator, e.g. when a neutral meson mixes, are followed to the last copy and extra
+//photons from final-state radiation are ignored
+class RapidTruthInputHepMC : public RapidTruthInput {
+	public:
+		RapidTruthInputHepMC(const std::vector<RapidParticle*>& parts)
+			: RapidTruthInput(parts), momentumUnit_(1.), lengthUnit_(1.), headId_(0), nSkipped_(0), suppressVertexWarning_(false)
+			{}
+
+		virtual ~RapidTruthInputHepMC() {}
+
+		virtual bool next();
+
+	protected:
+		virtual bool setup(TString fileName);
+
+	private:
+		//read the particles and vertices of the next event - false at the end of the file
+		bool readEvent();
+		void readUnits(std::istringstream& line);
+		void readParticle(std::istringstream& line);
+		void readVertex(std::istringstream& line);
+		bool readPosition(std::istringstream& line, TLorentzVector& pos);
+		void findChildren();
+
+		//find the decay in the current event and the particle of the event matched to each particle of the decay
+		bool findDecay();
+		bool matchDecay(int id, unsigned int index, int sign);
+		bool matchDaughters(const std::vector<int>& children, std::vector<bool>& used, unsigned int index, unsigned int daughter, int sign);
+		int lastCopy(int id);
+
+		//position of the vertex that a particle was produced in
+		TLorentzVector productionPosition(int id);
+
+		std::ifstream file_;
+		//the first line of the next event, read while looking for the end of the current one
+		std::string pendingLine_;
+
+		//units of the current event in GeV and mm
+		double momentumUnit_;
+		double lengthUnit_;
+
+		//particles of the current event by id
+		std::vector<int> pdg_;
+		std::vector<int> parent_;
+		std::vector<TLorentzVector> momenta_;
+		std::vector<std::vector<int> > children_;
+		std::vector<bool> hasEndPosition_;
+		std::vector<TLorentzVector> endPositions_;
+
+		//vertices of the current event by minus their id
+		std::vector<std::vector<int> > vertexIn_;
+		std::vector<bool> hasVertexPosition_;
+		std::vector<TLorentzVector> vertexPositions_;
+
+		//position of the root vertex of the current event
+		TLorentzVector eventPosition_;
+
+		//index in the decay of the daughters of each particle
+		std::vector<std::vector<unsigned int> > daughterIndices_;
+		//particle of the event matched to each particle of the decay and the first copy of the parent
+		std::vector<int> match_;
+		int headId_;
+
+		Long64_t nSkipped_;
+		bool suppressVertexWarning_;
+};
+
+#endif
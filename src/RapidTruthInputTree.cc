@@ -0,0 +1,123 @@
+#include "RapidTruthInputTree.h"
+
+#include <iostream>
+
+#include "TLorentzVector.h"
+
+#include "RapidParticle.h"
+
+RapidTruthInputTree::~RapidTruthInputTree() {
+	if(file_) {
+		file_->Close();
+		delete file_;
+	}
+}
+
+bool RapidTruthInputTree::next() {
+	if(entry_>=nEntries_) {
+		atEnd_ = true;
+		return false;
+	}
+	tree_->GetEntry(entry_++);
+
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		TLorentzVector p;
+		if(e_[i]) {
+			p.SetPxPyPzE(px_[i]->GetValue(), py_[i]->GetValue(), pz_[i]->GetValue(), e_[i]->GetValue());
+		} else {
+			double mass = m_[i] ? m_[i]->GetValue() : parts_[i]->mass();
+			p.SetXYZM(px_[i]->GetValue(), py_[i]->GetValue(), pz_[i]->GetValue(), mass);
+		}
+		parts_[i]->setP(p);
+	}
+
+	//mothers come before their daughters so the PV is set before any decay vertex
+	if(!pv_.empty()) setPV(pv_[0]->GetValue(), pv_[1]->GetValue(), pv_[2]->GetValue());
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		if(vtx_[i].empty()) continue;
+		setDecayVertex(i, vtx_[i][0]->GetValue(), vtx_[i][1]->GetValue(), vtx_[i][2]->GetValue());
+	}
+
+	++nRead_;
+	return true;
+}
+
+bool RapidTruthInputTree::setup(TString fileName) {
+	TString treeName("DecayTree");
+	int pos = fileName.Index(".root:");
+	if(pos>=0) {
+		treeName = fileName(pos+6, fileName.Length()-pos-6);
+		fileName = fileName(0, pos+5);
+	}
+
+	file_ = TFile::Open(fileName, "READ");
+	if(!file_ || file_->IsZombie()) {
+		std::cout << "ERROR in RapidTruthInputTree::setup : failed to open file " << fileName << "." << std::endl;
+		return false;
+	}
+	file_->GetObject(treeName, tree_);
+	if(!tree_) {
+		std::cout << "ERROR in RapidTruthInputTree::setup : tree " << treeName << " not found in file " << fileName << "." << std::endl;
+		return false;
+	}
+	nEntries_ = tree_->GetEntries();
+
+	//only the true decay is read, a cluster of entries at a time
+	tree_->SetBranchStatus("*", 0);
+	tree_->SetCacheSize(32*1024*1024);
+
+	const char* coords[3] = {"X", "Y", "Z"};
+	hasVertices_ = true;
+
+	for(unsigned int i=0; i<parts_.size(); ++i) {
+		RapidParticle* part = parts_[i];
+		TString name = part->name();
+
+		px_.push_back(findLeaf(name+"_PX_TRUE"));
+		py_.push_back(findLeaf(name+"_PY_TRUE"));
+		pz_.push_back(findLeaf(name+"_PZ_TRUE"));
+		e_.push_back(findLeaf(name+"_E_TRUE"));
+		m_.push_back(findLeaf(name+"_M_TRUE"));
+
+		if(!px_[i] || !py_[i] || !pz_[i]) {
+			std::cout << "ERROR in RapidTruthInputTree::setup : momentum of " << name << " not found in tree " << treeName << "." << std::endl
+				  << "                                      branches " << name << "_PX_TRUE, " << name << "_PY_TRUE and " << name << "_PZ_TRUE are required." << std::endl;
+			return false;
+		}
+
+		vtx_.push_back(std::vector<TLeaf*>());
+		if(part->nDaughters()>0 && part->ctau()>0) {
+			for(int j=0; j<3; ++j) {
+				TLeaf* leaf = findLeaf(name+"_vtx"+coords[j]+"_TRUE");
+				if(leaf) vtx_[i].push_back(leaf);
+			}
+			if(vtx_[i].size()<3) {
+				vtx_[i].clear();
+				hasVertices_ = false;
+			}
+		}
+	}
+
+	for(int j=0; j<3; ++j) {
+		TLeaf* leaf = findLeaf(parts_[0]->name()+"_orig"+coords[j]+"_TRUE");
+		if(leaf) pv_.push_back(leaf);
+	}
+	if(pv_.size()<3) pv_.clear();
+
+	if(!hasVertices_) {
+		std::cout << "WARNING in RapidTruthInputTree::setup : decay vertices not found in tree " << treeName << "." << std::endl
+			  << "                                        they will be generated from the lifetimes of the particles." << std::endl;
+	}
+
+	std::cout << "INFO in RapidTruthInputTree::setup : reading " << nEntries_ << " true decays from tree " << treeName << " in file " << fileName << "." << std::endl;
+	return true;
+}
+
+TLeaf* RapidTruthInputTree::findLeaf(TString name) {
+	TLeaf* leaf = tree_->GetLeaf(name);
+	if(leaf) {
+		tree_->SetBranchStatus(name, 1);
+		tree_->AddBranchToCache(name);
+	}
+	return leaf;
+}
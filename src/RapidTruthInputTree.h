@@ -0,0 +1,49 @@
+#ifndef RAPIDTRUTHINPUTTREE_H
+#define RAPIDTRUTHINPUTTREE_H
+
+#include <vector>
+
+#include "TFile.h"
+#include "TLeaf.h"
+#include "TTree.h"
+
+#include "RapidTruthInput.h"
+
+//true decays read from the TRUE branches of a tree written by RapidSim or in the same format
+//
+//only the branches that are needed are read and entries are loaded through the tree cache a cluster at a time
+class RapidTruthInputTree : public RapidTruthInput {
+	public:
+		RapidTruthInputTree(const std::vector<RapidParticle*>& parts)
+			: RapidTruthInput(parts), file_(0), tree_(0), entry_(0), nEntries_(0)
+			{}
+
+		virtual ~RapidTruthInputTree();
+
+		virtual bool next();
+
+	protected:
+		virtual bool setup(TString fileName);
+
+	private:
+		//find the leaf of a branch and add it to those that are read
+		TLeaf* findLeaf(TString name);
+
+		TFile* file_;
+		TTree* tree_;
+		Long64_t entry_;
+		Long64_t nEntries_;
+
+		//momentum of each particle - its energy is found from the mass when no energy branch is available
+		std::vector<TLeaf*> px_;
+		std::vector<TLeaf*> py_;
+		std::vector<TLeaf*> pz_;
+		std::vector<TLeaf*> e_;
+		std::vector<TLeaf*> m_;
+
+		//origin vertex of the parent and decay vertices of the long-lived particles, if available
+		std::vector<TLeaf*> pv_;
+		std::vector<std::vector<TLeaf*> > vtx_;
+};
+
+#endif
@@ -15,10 +15,12 @@ class RapidVertex {
 
 		void setXYZ(double x, double y, double z);
 		void setNtracks(unsigned int ntracks) { ntracks_ = ntracks; smearVertex();}
+		unsigned int ntracks() { return ntracks_; }
 
-	private:
+		//smear again from the true position
 		void smearVertex();
 
+	private:
 		unsigned int ntracks_;
 		ROOT::Math::XYZPoint vertexTrue_;
 		ROOT::Math::XYZPoint vertexSmeared_;
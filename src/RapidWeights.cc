@@ -0,0 +1,139 @@
+#include "RapidWeights.h"
+
+#include <iostream>
+
+#include "TLorentzVector.h"
+
+#include "RapidParam.h"
+#include "RapidParticle.h"
+
+RapidWeights::~RapidWeights() {
+	for(unsigned int i=0; i<names_.size(); ++i) {
+		if(ptHistos_[i]) delete ptHistos_[i];
+		if(etaHistos_[i]) delete etaHistos_[i];
+		if(shapes_[i]) delete shapes_[i];
+	}
+	if(nominalShape_) delete nominalShape_;
+}
+
+bool RapidWeights::addVariation(TString name) {
+	for(unsigned int i=0; i<names_.size(); ++i) {
+		if(names_[i]==name) {
+			std::cout << "ERROR in RapidWeights::addVariation : weight " << name << " has already been declared." << std::endl;
+			return false;
+		}
+	}
+
+	names_.push_back(name);
+	weights_.push_back(1.);
+	ptHistos_.push_back(0);
+	etaHistos_.push_back(0);
+	ptNorms_.push_back(0.);
+	etaNorms_.push_back(0.);
+	shapes_.push_back(0);
+	shapeNorms_.push_back(0.);
+
+	return true;
+}
+
+void RapidWeights::setNominalKinematics(RapidParticle* parent, TH1* ptHisto, TH1* etaHisto) {
+	parent_ = parent;
+	nominalPt_ = ptHisto;
+	nominalEta_ = etaHisto;
+	nominalPtNorm_ = ptHisto->Integral("width");
+	nominalEtaNorm_ = etaHisto->Integral("width");
+}
+
+void RapidWeights::setNominalShape(TH1* shape, RapidParam* paramX, RapidParam* paramY) {
+	if(nominalShape_) delete nominalShape_;
+	nominalShape_ = shape;
+	nominalShapeNorm_ = shape->Integral("width");
+	shapeParamX_ = paramX;
+	shapeParamY_ = paramY;
+}
+
+bool RapidWeights::setKinematics(unsigned int i, TH1* ptHisto, TH1* etaHisto) {
+	double ptNorm = ptHisto->Integral("width");
+	double etaNorm = etaHisto->Integral("width");
+	if(ptNorm<=0. || etaNorm<=0.) {
+		std::cout << "ERROR in RapidWeights::setKinematics : alternative kinematics of weight " << names_[i] << " are empty in the generated range." << std::endl;
+		return false;
+	}
+
+	ptHistos_[i] = ptHisto;
+	etaHistos_[i] = etaHisto;
+	ptNorms_[i] = ptNorm;
+	etaNorms_[i] = etaNorm;
+	return true;
+}
+
+bool RapidWeights::setShape(unsigned int i, TH1* shape) {
+	if(!nominalShape_) {
+		std::cout << "ERROR in RapidWeights::setShape : weight " << names_[i] << " requires a nominal shape to be set." << std::endl;
+		return false;
+	}
+	if(shape->GetDimension()!=nominalShape_->GetDimension()) {
+		std::cout << "ERROR in RapidWeights::setShape : shape of weight " << names_[i] << " has " << shape->GetDimension() << " dimensions but the nominal shape has " << nominalShape_->GetDimension() << "." << std::endl;
+		return false;
+	}
+	double norm = shape->Integral("width");
+	if(norm<=0.) {
+		std::cout << "ERROR in RapidWeights::setShape : shape of weight " << names_[i] << " is empty." << std::endl;
+		return false;
+	}
+
+	shapes_[i] = shape;
+	shapeNorms_[i] = norm;
+	return true;
+}
+
+void RapidWeights::calculate() {
+	//the kinematics and shape parameters are shared by all variations
+	double pt(0.), eta(0.);
+	if(parent_) {
+		TLorentzVector& p = parent_->getP();
+		pt = p.Pt();
+		eta = p.Eta();
+	}
+
+	double nominalShape(0.);
+	if(nominalShape_) nominalShape = shapeDensity(nominalShape_, nominalShapeNorm_);
+
+	for(unsigned int i=0; i<names_.size(); ++i) {
+		if(shapes_[i]) {
+			weights_[i] = nominalShape>0. ? shapeDensity(shapes_[i], shapeNorms_[i])/nominalShape : 0.;
+		} else {
+			weights_[i] = kinematicsWeight(i, pt, eta);
+		}
+	}
+}
+
+double RapidWeights::binDensity(TH1* hist, double norm, double x) {
+	int bin = hist->FindBin(x);
+	if(hist->IsBinOverflow(bin) || hist->IsBinUnderflow(bin)) return 0.;
+	return hist->GetBinContent(bin)/(norm*hist->GetBinWidth(bin));
+}
+
+double RapidWeights::shapeDensity(TH1* hist, double norm) {
+	double valX = shapeParamX_->eval();
+	if(shapeParamY_) {
+		double valY = shapeParamY_->eval();
+		int bin = hist->FindBin(valX,valY);
+		if(hist->IsBinOverflow(bin) || hist->IsBinUnderflow(bin)) return 0.;
+		return hist->Interpolate(valX,valY)/norm;
+	}
+
+	int bin = hist->FindBin(valX);
+	if(hist->IsBinOverflow(bin) || hist->IsBinUnderflow(bin)) return 0.;
+	return hist->Interpolate(valX)/norm;
+}
+
+double RapidWeights::kinematicsWeight(unsigned int i, double pt, double eta) {
+	if(!ptHistos_[i] || !nominalPt_) return 1.;
+
+	//the parent pT and eta are generated independently
+	double nominal = binDensity(nominalPt_, nominalPtNorm_, pt) * binDensity(nominalEta_, nominalEtaNorm_, eta);
+	if(nominal<=0.) return 0.;
+
+	return binDensity(ptHistos_[i], ptNorms_[i], pt) * binDensity(etaHistos_[i], etaNorms_[i], eta) / nominal;
+}
@@ -0,0 +1,84 @@
+#ifndef RAPIDWEIGHTS_H
+#define RAPIDWEIGHTS_H
+
+#include <vector>
+
+#include "TH1.h"
+#include "TString.h"
+
+class RapidParam;
+class RapidParticle;
+
+//per-event weights that reweight the generated sample to alternative generator settings
+//
+//each weight is the ratio of the density of the alternative setting to that of the nominal setting, evaluated for the
+//current event - either the product of the ratios of the parent pT and eta densities or the ratio of the shape densities
+class RapidWeights {
+	public:
+		RapidWeights()
+			: parent_(0), nominalPt_(0), nominalEta_(0), nominalPtNorm_(0.), nominalEtaNorm_(0.),
+			  nominalShape_(0), nominalShapeNorm_(0.), shapeParamX_(0), shapeParamY_(0)
+			{}
+
+		~RapidWeights();
+
+		//declare an alternative setting - its densities are set once the nominal ones are known
+		bool addVariation(TString name);
+
+		unsigned int nVariations() { return names_.size(); }
+		TString name(unsigned int i) { return names_[i]; }
+
+		//the nominal parent kinematics - not owned
+		void setNominalKinematics(RapidParticle* parent, TH1* ptHisto, TH1* etaHisto);
+		//the nominal shape - owned, and must not have been corrected for the phase-space distribution
+		void setNominalShape(TH1* shape, RapidParam* paramX, RapidParam* paramY);
+		bool hasNominalShape() { return nominalShape_!=0; }
+
+		//alternative densities of variation i - owned
+		bool setKinematics(unsigned int i, TH1* ptHisto, TH1* etaHisto);
+		bool setShape(unsigned int i, TH1* shape);
+
+		//find the weights of the current event
+		void calculate();
+
+		double weight(unsigned int i) { return weights_[i]; }
+		//the weight of each variation, at a fixed address for the branches of the tree
+		const std::vector<double>& values() { return weights_; }
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidWeights( const RapidWeights& other );
+		RapidWeights& operator=( const RapidWeights& other );
+
+		//density of a normalised histogram at a point - interpolated for shapes as in the accept/reject
+		double binDensity(TH1* hist, double norm, double x);
+		double shapeDensity(TH1* hist, double norm);
+
+		double kinematicsWeight(unsigned int i, double pt, double eta);
+
+		std::vector<TString> names_;
+		std::vector<double> weights_;
+
+		//alternative parent kinematics and their normalisations
+		std::vector<TH1*> ptHistos_;
+		std::vector<TH1*> etaHistos_;
+		std::vector<double> ptNorms_;
+		std::vector<double> etaNorms_;
+
+		//alternative shapes and their normalisations
+		std::vector<TH1*> shapes_;
+		std::vector<double> shapeNorms_;
+
+		RapidParticle* parent_;
+		TH1* nominalPt_;
+		TH1* nominalEta_;
+		double nominalPtNorm_;
+		double nominalEtaNorm_;
+
+		TH1* nominalShape_;
+		double nominalShapeNorm_;
+		RapidParam* shapeParamX_;
+		RapidParam* shapeParamY_;
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "RapidWorkerPool.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "TFileMerger.h"
+#include "TRandom.h"
+#include "TSystem.h"
+
+bool RapidWorkerPool::inWorker_ = false;
+
+bool RapidWorkerPool::start() {
+	//drawn from the parent's generator so that a fixed seed still gives a reproducible run
+	seeds_.clear();
+	for(unsigned int i=0; i<nWorkers_; ++i) {
+		seeds_.push_back(gRandom->Integer(2147483647u)+1);
+	}
+
+	std::cout << "INFO in RapidWorkerPool::start : starting " << nWorkers_ << " workers" << std::endl;
+
+	//anything still buffered would otherwise be written by every worker
+	std::cout.flush();
+	fflush(stdout);
+
+	for(unsigned int i=0; i<nWorkers_; ++i) {
+		int fds[2];
+		if(pipe(fds)!=0) {
+			std::cout << "ERROR in RapidWorkerPool::start : failed to create pipe for worker " << i << "." << std::endl;
+			stop();
+			return false;
+		}
+
+		pid_t pid = fork();
+		if(pid<0) {
+			std::cout << "ERROR in RapidWorkerPool::start : failed to start worker " << i << "." << std::endl;
+			close(fds[0]);
+			close(fds[1]);
+			stop();
+			return false;
+		}
+
+		if(pid==0) {
+			close(fds[0]);
+			for(unsigned int j=0; j<pipes_.size(); ++j) {
+				close(pipes_[j]);
+			}
+			pipes_.clear();
+			pids_.clear();
+			pipe_ = fds[1];
+			worker_ = i;
+			inWorker_ = true;
+			return true;
+		}
+
+		close(fds[1]);
+		pids_.push_back(pid);
+		pipes_.push_back(fds[0]);
+	}
+
+	return true;
+}
+
+int RapidWorkerPool::share(int n) {
+	if(n<=0) return n;
+	int nShare = n/nWorkers_;
+	if(worker_ < n%static_cast<int>(nWorkers_)) ++nShare;
+	return nShare;
+}
+
+void RapidWorkerPool::report(int ngenerated, int nselected) {
+	if(pipe_<0) return;
+
+	TString counters = TString::Format("%d %d\n", ngenerated, nselected);
+	if(write(pipe_, counters.Data(), counters.Length())!=counters.Length()) {
+		std::cout << "WARNING in RapidWorkerPool::report : failed to report counters of worker " << worker_ << "." << std::endl;
+	}
+	close(pipe_);
+	pipe_ = -1;
+
+	std::cout.flush();
+}
+
+bool RapidWorkerPool::wait(TString name, bool saveTree, RapidTreeSettings& treeSettings, int& ngenerated, int& nselected) {
+	bool success(true);
+	ngenerated = 0;
+	nselected = 0;
+
+	for(unsigned int i=0; i<pids_.size(); ++i) {
+		TString counters;
+		char buffer[256];
+		ssize_t nRead(0);
+		while((nRead = read(pipes_[i], buffer, sizeof(buffer)-1))>0) {
+			buffer[nRead] = '\0';
+			counters += buffer;
+		}
+		close(pipes_[i]);
+
+		int status(0);
+		waitpid(pids_[i], &status, 0);
+
+		int nGenWorker(0), nSelWorker(0);
+		if(!WIFEXITED(status) || WEXITSTATUS(status)!=0 || sscanf(counters.Data(), "%d %d", &nGenWorker, &nSelWorker)!=2) {
+			std::cout << "ERROR in RapidWorkerPool::wait : worker " << i << " did not finish." << std::endl;
+			success = false;
+			continue;
+		}
+		ngenerated += nGenWorker;
+		nselected += nSelWorker;
+	}
+	pids_.clear();
+	pipes_.clear();
+
+	if(!success) return false;
+
+	std::vector<TString> histFiles, treeFiles;
+	for(unsigned int i=0; i<nWorkers_; ++i) {
+		TString workerName = name + suffix(i);
+		histFiles.push_back(workerName+"_hists.root");
+		if(saveTree) treeFiles.push_back(workerName+"_tree.root");
+	}
+
+	if(!merge(name+"_hists.root", histFiles)) return false;
+	if(!saveTree) return true;
+
+	//rolled over files are kept within their size limits rather than merged into one
+	if(treeSettings.rollover()) return mergeIndex(name);
+	return merge(name+"_tree.root", treeFiles, treeSettings.compression());
+}
+
+bool RapidWorkerPool::merge(TString output, const std::vector<TString>& inputs, int compression) {
+	std::cout << "INFO in RapidWorkerPool::merge : merging output of the workers into " << output << std::endl;
+
+	//with the compression of the workers' files their baskets are copied without being recompressed
+	TFileMerger merger(kFALSE);
+	merger.SetPrintLevel(0);
+	bool opened = compression>=0 ? merger.OutputFile(output, "RECREATE", compression) : merger.OutputFile(output, "RECREATE");
+	if(!opened) {
+		std::cout << "ERROR in RapidWorkerPool::merge : failed to open " << output << "." << std::endl;
+		return false;
+	}
+	for(unsigned int i=0; i<inputs.size(); ++i) {
+		if(!merger.AddFile(inputs[i], kFALSE)) {
+			std::cout << "ERROR in RapidWorkerPool::merge : failed to open " << inputs[i] << "." << std::endl;
+			return false;
+		}
+	}
+	if(!merger.Merge()) {
+		std::cout << "ERROR in RapidWorkerPool::merge : failed to merge into " << output << "." << std::endl;
+		return false;
+	}
+
+	for(unsigned int i=0; i<inputs.size(); ++i) {
+		gSystem->Unlink(inputs[i]);
+	}
+	return true;
+}
+
+bool RapidWorkerPool::mergeIndex(TString name) {
+	TString indexName = name+"_tree_index.txt";
+	std::cout << "INFO in RapidWorkerPool::mergeIndex : renumbering the tree files of the workers into " << indexName << std::endl;
+
+	std::ofstream fout;
+	fout.open(indexName+".tmp", std::ofstream::out);
+
+	int nFiles(0);
+	for(unsigned int i=0; i<nWorkers_; ++i) {
+		TString workerName = name + suffix(i);
+		TString workerIndex = workerName+"_tree_index.txt";
+
+		std::ifstream fin;
+		fin.open(workerIndex, std::ifstream::in);
+		if(!fin.good()) {
+			std::cout << "ERROR in RapidWorkerPool::mergeIndex : failed to open " << workerIndex << "." << std::endl;
+			return false;
+		}
+
+		//the title line is the same for every worker
+		TString buffer;
+		buffer.ReadLine(fin);
+		if(i==0) fout << buffer << "\n";
+
+		//the files are listed in order and a last file without entries is not listed
+		int index(1);
+		TString file, first, last, entries;
+		while(file.ReadToken(fin) && first.ReadToken(fin) && last.ReadToken(fin) && entries.ReadToken(fin)) {
+			TString input = TString::Format("%s_tree_%04d.root", workerName.Data(), index++);
+			TString output = TString::Format("%s_tree_%04d.root", name.Data(), ++nFiles);
+			if(gSystem->Rename(input, output)!=0) {
+				std::cout << "ERROR in RapidWorkerPool::mergeIndex : failed to move " << input << " to " << output << "." << std::endl;
+				return false;
+			}
+			fout << gSystem->BaseName(output) << "\t" << first << "\t" << last << "\t" << entries << "\n";
+		}
+		fin.close();
+
+		for( ; ; ++index) {
+			TString input = TString::Format("%s_tree_%04d.root", workerName.Data(), index);
+			if(gSystem->AccessPathName(input)) break;
+			gSystem->Unlink(input);
+		}
+		gSystem->Unlink(workerIndex);
+	}
+	fout.close();
+
+	if(gSystem->Rename(indexName+".tmp", indexName)!=0) {
+		std::cout << "ERROR in RapidWorkerPool::mergeIndex : failed to write " << indexName << "." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void RapidWorkerPool::stop() {
+	for(unsigned int i=0; i<pids_.size(); ++i) {
+		kill(pids_[i], SIGTERM);
+		close(pipes_[i]);
+		waitpid(pids_[i], 0, 0);
+	}
+	pids_.clear();
+	pipes_.clear();
+}
@@ -0,0 +1,71 @@
+#ifndef RAPIDWORKERPOOL_H
+#define RAPIDWORKERPOOL_H
+
+#include <vector>
+
+#include "TString.h"
+
+#include "RapidTreeSettings.h"
+
+//splits a run between worker processes forked once the decay has been set up
+//
+//the workers share the parent's read-only tables copy-on-write and each is given its own random seed
+//they write their output with a suffix and report their counters to the parent through a pipe
+//the parent then merges their histograms and trees, or with rolled over trees renumbers their files into one index
+class RapidWorkerPool {
+	public:
+		RapidWorkerPool(unsigned int nWorkers)
+			: nWorkers_(nWorkers), worker_(-1), pipe_(-1)
+			{}
+
+		~RapidWorkerPool() {}
+
+		//fork the workers - in a worker this returns with isWorker() true
+		bool start();
+
+		bool isWorker() { return worker_>=0; }
+		//whether this process is a worker of any pool
+		static bool inWorker() { return inWorker_; }
+
+		//seed for the random number generators of this worker
+		unsigned int seed() { return seeds_[worker_]; }
+		//suffix added to the output of this worker
+		TString suffix() { return suffix(worker_); }
+		//this worker's share of a number to be split between the workers
+		int share(int n);
+		//number in the full run of this worker's n-th parent - the workers take turns so that the numbers do not overlap
+		int eventNumber(int n) { return worker_<0 ? n : n*nWorkers_+worker_; }
+
+		//called by a worker once its output has been closed
+		void report(int ngenerated, int nselected);
+
+		//called by the parent to wait for the workers, add up their counters and merge their output
+		bool wait(TString name, bool saveTree, RapidTreeSettings& treeSettings, int& ngenerated, int& nselected);
+
+	private:
+		//copy constructor and copy assignment operator not implemented
+		RapidWorkerPool( const RapidWorkerPool& other );
+		RapidWorkerPool& operator=( const RapidWorkerPool& other );
+
+		TString suffix(unsigned int worker) { return TString::Format("_worker%d", worker); }
+
+		bool merge(TString output, const std::vector<TString>& inputs, int compression=-1);
+		bool mergeIndex(TString name);
+		void stop();
+
+		unsigned int nWorkers_;
+		int worker_;
+
+		std::vector<unsigned int> seeds_;
+
+		//processes and the read end of their pipes, held by the parent
+		std::vector<int> pids_;
+		std::vector<int> pipes_;
+
+		//write end of the pipe, held by a worker
+		int pipe_;
+
+		static bool inWorker_;
+};
+
+#endif
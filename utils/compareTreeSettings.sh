@@ -0,0 +1,75 @@
+#!/bin/bash
+
+# Compare the output rate and size of the tree for different output settings.
+# Usage: compareTreeSettings.sh <decay mode> <events to generate> [settings file]
+#
+# Each line of the optional settings file defines one configuration to test as
+# a label followed by the global settings to append to the .config file,
+# separated by ';', e.g.
+#   zstd5-float ; treeCompression : ZSTD 5 ; treeStorage : float
+# Lines starting with '#' are ignored.
+
+if [ $# -lt 2 ]; then
+	echo "Usage: $0 <decay mode> <events to generate> [settings file]"
+	exit 1
+fi
+
+MODE=$1
+NEVT=$2
+SETTINGS=$3
+
+if [ -z "${RAPIDSIM_ROOT}" ]; then
+	echo "ERROR in compareTreeSettings.sh : environment variable RAPIDSIM_ROOT is not set"
+	exit 1
+fi
+
+EXE=$(which RapidSim.exe 2>/dev/null)
+if [ -z "${EXE}" ]; then
+	EXE=${RAPIDSIM_ROOT}/build/src/RapidSim.exe
+fi
+
+if [ ! -f "${MODE}.decay" ] || [ ! -f "${MODE}.config" ]; then
+	echo "ERROR in compareTreeSettings.sh : ${MODE}.decay and ${MODE}.config must both exist"
+	exit 1
+fi
+
+DEFAULTS="default
+zlib1 ; treeCompression : ZLIB 1
+lzma5 ; treeCompression : LZMA 5
+lz4-4 ; treeCompression : LZ4 4
+zstd5 ; treeCompression : ZSTD 5
+zstd5-float ; treeCompression : ZSTD 5 ; treeStorage : float
+zstd5-trunc10 ; treeCompression : ZSTD 5 ; treeStorage : truncated 10
+zstd5-mt4 ; treeCompression : ZSTD 5 ; treeThreads : 4"
+
+if [ -n "${SETTINGS}" ]; then
+	DEFAULTS=$(grep -v "^#" ${SETTINGS})
+fi
+
+NAME=$(basename ${MODE})
+WORKDIR=$(mktemp -d)
+
+printf "%-20s %12s %12s %12s %12s\n" "settings" "MB" "bytes/event" "MB/s" "gen. time/s"
+
+while read -r LINE; do
+	[ -z "${LINE}" ] && continue
+	LABEL=$(echo "${LINE}" | cut -d';' -f1 | xargs)
+
+	# global settings must come before the particle settings so prepend them
+	cp ${MODE}.decay ${WORKDIR}/${NAME}.decay
+	echo "${LINE}" | cut -s -d';' -f2- | tr ';' '\n' | sed 's/^ *//' > ${WORKDIR}/${NAME}.config
+	cat ${MODE}.config >> ${WORKDIR}/${NAME}.config
+
+	LOG=$( cd ${WORKDIR} && ${EXE} ${WORKDIR}/${NAME} ${NEVT} 1 2>&1 )
+
+	MB=$(echo "${LOG}" | grep "compressed size   :" | awk '{print $4}')
+	BPE=$(echo "${LOG}" | grep "bytes per event" | awk '{print $5}')
+	RATE=$(echo "${LOG}" | grep "output rate" | awk '{print $4}')
+	TGEN=$(echo "${LOG}" | grep "seconds to generate" | awk '{print $5}')
+
+	printf "%-20s %12s %12s %12s %12s\n" "${LABEL}" "${MB}" "${BPE}" "${RATE}" "${TGEN}"
+
+	rm -f ${WORKDIR}/${NAME}_tree*.root ${WORKDIR}/${NAME}_tree_index.txt ${WORKDIR}/${NAME}_hists.root
+done <<< "${DEFAULTS}"
+
+rm -rf ${WORKDIR}
@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+"""Send jobs to a RapidSim service started with RapidSim.exe --serve <socket>.
+
+Usage:
+  rapidSimClient.py [--socket <socket>] [--set "<setting>"]... <mode> <numberToGenerate> [saveTree] [numberToRedecay] [options]
+  rapidSimClient.py [--socket <socket>] --stop
+
+The job is run by the service exactly as RapidSim.exe would run it from the service's working directory.
+Each --set gives a line in the format of the config file, e.g. "seed : 42" or "@1 smear : LHCbGeneric",
+that is applied after the config file has been read. The exit status is that of the job.
+
+The submit function may also be used from other scripts, e.g. to run a scan through one service.
+"""
+from __future__ import print_function
+
+import json
+import socket
+import sys
+
+
+def submit(socketPath, args, settings=None):
+    """Run a job and return its status, the output files and the run summary."""
+    request = " ".join(str(a) for a in args) + "\n"
+    for setting in settings or []:
+        request += setting + "\n"
+    request += "\n"
+
+    reply = _send(socketPath, request)
+
+    status = 1
+    files = {}
+    summary = None
+    lines = reply.split("\n")
+    for i, line in enumerate(lines):
+        key, _, value = line.partition(" ")
+        if key == "status":
+            status = int(value)
+        elif key in ("output", "hists", "summary"):
+            files[key] = value
+        elif line.startswith("{"):
+            summary = json.loads("\n".join(lines[i:]))
+            break
+
+    return status, files, summary
+
+
+def stop(socketPath):
+    """Ask the service to finish."""
+    _send(socketPath, "stop\n")
+
+
+def _send(socketPath, request):
+    client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    client.connect(socketPath)
+    client.sendall(request.encode())
+    chunks = []
+    while True:
+        data = client.recv(65536)
+        if not data:
+            break
+        chunks.append(data)
+    client.close()
+    return b"".join(chunks).decode()
+
+
+def main(argv):
+    socketPath = "rapidsim.sock"
+    settings = []
+    args = []
+    doStop = False
+
+    i = 0
+    while i < len(argv):
+        if argv[i] == "--socket" and i + 1 < len(argv):
+            socketPath = argv[i + 1]
+            i += 2
+        elif argv[i] == "--set" and i + 1 < len(argv):
+            settings.append(argv[i + 1])
+            i += 2
+        elif argv[i] == "--stop":
+            doStop = True
+            i += 1
+        else:
+            args.append(argv[i])
+            i += 1
+
+    if doStop:
+        stop(socketPath)
+        return 0
+
+    if len(args) < 2:
+        print(__doc__)
+        return 1
+
+    status, files, summary = submit(socketPath, args, settings)
+    print("INFO in rapidSimClient.py : job finished with status %d" % status)
+    for key in ("output", "hists", "summary"):
+        if key in files:
+            print("%-8s %s" % (key, files[key]))
+    if summary:
+        print("generated %d, selected %d in %.2f s"
+              % (summary["generated"], summary["selected"],
+                 summary["time"]["initialiseWall"] + summary["time"]["generateWall"]))
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
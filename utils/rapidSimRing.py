@@ -0,0 +1,235 @@
+#!/usr/bin/env python
+"""Read events written by RapidSim.exe --shm <name> from a shared-memory ring buffer.
+
+Usage:
+  rapidSimRing.py <name> [numberToRead]
+
+The layout of the ring and the protocol used to claim records are documented in src/RapidRingBuffer.h.
+Several readers, e.g. the workers of a PyTorch DataLoader, may read from the same ring and each event is read by
+exactly one of them. Records are claimed with an atomic compare-and-swap of the read cursor from libatomic; without
+libatomic only one reader may read from each ring at a time. The reader also relies on aligned 8-byte loads and
+stores being atomic and on the ordering of stores given by x86-64.
+
+A producer that stops part way through writing an event leaves a record that is never filled, which would block
+the readers. Call stop() from any process to ask the producers and readers to finish, or give batches() a timeout.
+
+The reader may be used from other scripts, e.g. in a PyTorch IterableDataset:
+
+  ring = RapidSimRing("rapidsim")
+  for batch in ring.batches(4096):
+      yield torch.from_numpy(batch)
+"""
+from __future__ import print_function
+
+import ctypes
+import ctypes.util
+import mmap
+import os
+import struct
+import sys
+import time
+
+import numpy as np
+
+MAGIC = b"RAPIDSHM"
+VERSION = 1
+NAME_LENGTH = 64
+
+SEQ_CST = 5
+
+
+def _loadAtomics():
+    """Return the atomic load and compare-and-swap of 8-byte values from libatomic, or None if it is not found."""
+    for name in ("libatomic.so.1", ctypes.util.find_library("atomic")):
+        if not name:
+            continue
+        try:
+            lib = ctypes.CDLL(name)
+            load = getattr(lib, "__atomic_load_8")
+            compareExchange = getattr(lib, "__atomic_compare_exchange_8")
+        except (OSError, AttributeError):
+            continue
+        load.restype = ctypes.c_uint64
+        load.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        compareExchange.restype = ctypes.c_bool
+        compareExchange.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint64, ctypes.c_bool,
+                                    ctypes.c_int, ctypes.c_int]
+        return load, compareExchange
+    return None
+
+
+class RapidSimRing(object):
+    """Consumer of a RapidSim shared-memory ring buffer."""
+
+    def __init__(self, name, timeout=60.):
+        path = "/dev/shm/" + name.lstrip("/")
+        start = time.time()
+        while True:
+            if os.path.exists(path) and os.path.getsize(path) > 0:
+                self._file = open(path, "r+b")
+                self._memory = mmap.mmap(self._file.fileno(), 0)
+                if struct.unpack_from("<I", self._memory, 8)[0] != 0:
+                    break
+                self._memory.close()
+                self._file.close()
+            if time.time() - start > timeout:
+                raise RuntimeError("ring buffer %s was not created in time" % name)
+            time.sleep(0.01)
+
+        self.path = path
+        if self._memory[0:8] != MAGIC:
+            raise RuntimeError("%s is not a RapidSim ring buffer" % path)
+        version, nColumns, capacity, recordSize, dataOffset = struct.unpack_from("<IIQQQ", self._memory, 8)
+        if version != VERSION:
+            raise RuntimeError("ring buffer %s has version %d, expected %d" % (path, version, VERSION))
+
+        self.columns = []
+        for i in range(nColumns):
+            raw = self._memory[192 + NAME_LENGTH * i:192 + NAME_LENGTH * (i + 1)]
+            self.columns.append(raw.split(b"\0", 1)[0].decode())
+        self.capacity = capacity
+
+        header = np.frombuffer(self._memory, dtype=np.uint32, count=16)
+        self._nProducers = header[10:11]
+        self._stop = header[11:12]
+        self._nAttached = header[12:13]
+        cursors = np.frombuffer(self._memory, dtype=np.uint64, count=24)
+        self._writeCursor = cursors[8:9]
+        self._readCursor = cursors[16:17]
+
+        self._atomics = _loadAtomics()
+        if self._atomics is None:
+            print("WARNING in rapidSimRing.py : libatomic not found, only one reader may read from ring buffer %s" % path)
+        self._readCursorAddress = self._readCursor.ctypes.data
+        self._expected = ctypes.c_uint64(0)
+
+        self._sequence = np.ndarray((capacity,), dtype=np.uint64, buffer=self._memory,
+                                    offset=dataOffset, strides=(recordSize,))
+        self._values = np.ndarray((capacity, nColumns), dtype=np.float32, buffer=self._memory,
+                                  offset=dataOffset + 8, strides=(recordSize, 4))
+
+    def _loadReadCursor(self):
+        if self._atomics is None:
+            return int(self._readCursor[0])
+        return self._atomics[0](self._readCursorAddress, SEQ_CST)
+
+    def _claim(self, position, nEvents):
+        """Move the read cursor past nEvents records from position - False if another reader moved it first."""
+        if self._atomics is None:
+            self._readCursor[0] = np.uint64(position + nEvents)
+            return True
+        self._expected.value = position
+        return self._atomics[1](self._readCursorAddress, ctypes.byref(self._expected), position + nEvents,
+                                False, SEQ_CST, SEQ_CST)
+
+    def _nReady(self, position, n):
+        positions = np.uint64(position) + np.arange(n, dtype=np.uint64)
+        slots = positions & np.uint64(self.capacity - 1)
+        ready = self._sequence[slots] == positions + np.uint64(1)
+        return (n if ready.all() else int(np.argmin(ready))), positions, slots
+
+    def read(self, maxEvents):
+        """Return up to maxEvents of the events that are ready as an array of shape (n, columns)."""
+        n = min(maxEvents, self.capacity)
+        while n > 0:
+            position = self._loadReadCursor()
+            nReady, positions, slots = self._nReady(position, n)
+            if nReady == 0:
+                break
+
+            # a claimed record is not written again until it is freed so it may be copied after the claim
+            if not self._claim(position, nReady):
+                continue
+            slots = slots[:nReady]
+            events = self._values[slots]
+            self._sequence[slots] = positions[:nReady] + np.uint64(self.capacity)
+            return events
+        return self._values[:0].copy()
+
+    def finished(self):
+        """Whether every producer that attached has detached and none of their events are left to read."""
+        if self._nAttached[0] == 0 or self._nProducers[0] != 0:
+            return False
+        # a producer that was stopped may have claimed a record without writing it
+        return self._nReady(self._loadReadCursor(), 1)[0] == 0
+
+    def stopped(self):
+        """Whether a reader has asked the producers to finish."""
+        return self._stop[0] != 0
+
+    def batches(self, batchSize, maxEvents=None, timeout=None):
+        """Yield arrays of batchSize events until the producers finish, a reader calls stop() or maxEvents have been read.
+
+        With a timeout, a RuntimeError is raised if no event becomes ready for that many seconds, e.g. because a
+        producer stopped part way through writing an event.
+        """
+        nRead = 0
+        pending = []
+        nPending = 0
+        lastEvent = time.time()
+        while maxEvents is None or nRead < maxEvents:
+            wanted = batchSize - nPending
+            if maxEvents is not None:
+                wanted = min(wanted, maxEvents - nRead - nPending)
+            events = self.read(wanted)
+            if len(events):
+                pending.append(events)
+                nPending += len(events)
+                lastEvent = time.time()
+            if nPending == batchSize or (maxEvents is not None and nRead + nPending == maxEvents):
+                yield np.concatenate(pending)
+                nRead += nPending
+                pending = []
+                nPending = 0
+            elif not len(events):
+                if self.finished() or self.stopped():
+                    break
+                if timeout is not None and time.time() - lastEvent > timeout:
+                    raise RuntimeError("no events were ready in ring buffer %s for %g s" % (self.path, timeout))
+                time.sleep(0.0001)
+        if nPending:
+            yield np.concatenate(pending)
+
+    def stop(self):
+        """Ask the producers, and the other readers once the events that are ready have been read, to finish."""
+        self._stop[0] = 1
+
+    def close(self, unlink=True):
+        """Stop reading and, by default, remove the ring so that the next producer creates a new one."""
+        self._sequence = self._values = None
+        self._nProducers = self._stop = self._nAttached = None
+        self._writeCursor = self._readCursor = None
+        self._memory.close()
+        self._file.close()
+        if unlink and os.path.exists(self.path):
+            os.unlink(self.path)
+
+
+def main(argv):
+    if len(argv) < 1:
+        print(__doc__)
+        return 1
+
+    ring = RapidSimRing(argv[0])
+    maxEvents = int(float(argv[1])) if len(argv) > 1 else None
+
+    start = time.time()
+    nRead = 0
+    sums = np.zeros(len(ring.columns))
+    for batch in ring.batches(65536, maxEvents):
+        nRead += len(batch)
+        sums += batch.sum(axis=0)
+    elapsed = time.time() - start
+
+    ring.stop()
+    ring.close()
+
+    print("INFO in rapidSimRing.py : read %d events in %.2f s (%.0f per second)"
+          % (nRead, elapsed, nRead / elapsed if elapsed > 0 else 0.))
+    for name, total in zip(ring.columns, sums):
+        print("%-32s mean %g" % (name, total / nRead if nRead else 0.))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,250 @@
+#!/usr/bin/env python
+"""Generate synthetic decays of configurable complexity and measure how RapidSim scales with them.
+
+Usage:
+  stressDecay.py generate [options] <name>
+      writes <name>.decay and <name>.config
+  stressDecay.py scan --vary <setting> --values <v1,v2,...> [options]
+      generates one decay for each value of the setting, runs them through validation/runBenchmark.sh
+      and tabulates the initialisation time, rates and memory against the value in <output>/scaling.csv
+
+The decays are built from a chain of intermediate states, Bc+ -> D0 -> KS, with the given number of
+decay levels (depth). Each decay vertex has the given number of daughters (multiplicity), of which all
+but the next intermediate state are charged pions. Broad resonances (rho0 -> pi+ pi- and
+K*0 -> K+ pi-) are added to the parent decay and the first few tracks are given an alternative mass
+hypothesis. All tracks are smeared and two- and three-body masses are added for every combination.
+"""
+from __future__ import print_function
+
+import argparse
+import collections
+import os
+import subprocess
+import sys
+
+# masses in GeV of the particles used, as in config/particles.dat
+MASSES = {"Bc+": 6.2751, "D0": 1.86484, "KS": 0.497611,
+          "pi+": 0.13957018, "pi-": 0.13957018, "K+": 0.493677,
+          "rho0": 0.77526, "K*0": 0.89581}
+
+# intermediate states for each level of the decay chain
+LADDER = ["Bc+", "D0", "KS"]
+
+# the KS is only allowed to decay to two pions
+FIXED = {"KS": ["pi+", "pi-"]}
+
+RESONANCES = [("rho0", ["pi+", "pi-"]), ("K*0", ["K+", "pi-"])]
+
+ALTMASS = {"pi+": "K+", "pi-": "K-", "K+": "pi+"}
+
+SETTINGS = ["depth", "multiplicity", "resonances", "altmass", "pileup"]
+
+
+class Node(object):
+    def __init__(self, name, daughters=None):
+        self.name = name
+        self.daughters = daughters if daughters else []
+
+    def mass(self):
+        return MASSES[self.name]
+
+
+def buildDecay(depth, multiplicity, resonances):
+    """Build the decay tree, checking that every decay is kinematically allowed."""
+    if depth < 1 or depth > len(LADDER):
+        raise ValueError("depth must be between 1 and %d" % len(LADDER))
+    if multiplicity < 2:
+        raise ValueError("multiplicity must be at least 2")
+
+    def tracks(n, first=0):
+        return [Node("pi+" if (first + i) % 2 == 0 else "pi-") for i in range(n)]
+
+    # build from the bottom of the chain upwards
+    node = None
+    for level in reversed(range(depth)):
+        name = LADDER[level]
+        if name in FIXED:
+            daughters = [Node(d) for d in FIXED[name]]
+        elif node is None:
+            daughters = tracks(multiplicity)
+        else:
+            daughters = [node] + tracks(multiplicity - 1, 1)
+        node = Node(name, daughters)
+
+    for i in range(resonances):
+        res, daughters = RESONANCES[i % len(RESONANCES)]
+        node.daughters.append(Node(res, [Node(d) for d in daughters]))
+
+    def check(part):
+        if not part.daughters:
+            return
+        total = sum(d.mass() for d in part.daughters)
+        if total >= part.mass():
+            raise ValueError("decay of %s to %d daughters is kinematically forbidden (%.3f >= %.3f GeV)"
+                             % (part.name, len(part.daughters), total, part.mass()))
+        for d in part.daughters:
+            check(d)
+    check(node)
+
+    return node
+
+
+def descriptor(node, top=True):
+    if not node.daughters:
+        return node.name
+    text = node.name + " -> " + " ".join(descriptor(d, False) for d in node.daughters)
+    return text if top else "{ " + text + " }"
+
+
+def flatten(node):
+    """Particles in the order RapidSim indexes them.
+
+    RapidConfig::loadDecay queues the sub-decays, so the particles are numbered breadth-first: the parent, its
+    daughters, then the daughters of each of those in turn."""
+    parts = []
+    queue = collections.deque([node])
+    while queue:
+        part = queue.popleft()
+        if not parts:
+            parts.append(part)
+        parts.extend(part.daughters)
+        queue.extend(d for d in part.daughters if d.daughters)
+    return parts
+
+
+def writeDecay(name, depth, multiplicity, resonances, altmass, pileup, pid):
+    top = buildDecay(depth, multiplicity, resonances)
+    parts = flatten(top)
+    stable = [p for p in parts if not p.daughters]
+
+    with open(name + ".decay", "w") as fout:
+        fout.write(descriptor(top) + "\n")
+
+    paramsStable = "P, PT, IP, MINIP"
+    if pid:
+        paramsStable += ", ProbNNpi, ProbNNk"
+
+    with open(name + ".config", "w") as fout:
+        fout.write("geometry : LHCb\n")
+        fout.write("pileup : %d\n" % pileup)
+        if pid:
+            fout.write("pid : LHCbGenericPID\n")
+        fout.write("paramsDecaying : M, P, PT, FD\n")
+        fout.write("paramsStable : %s\n" % paramsStable)
+        fout.write("paramsTwoBody : M2\n")
+        fout.write("paramsThreeBody : M2\n")
+        nAlt = 0
+        for i, part in enumerate(parts):
+            if part.daughters:
+                continue
+            fout.write("@%d\n" % i)
+            fout.write("\tsmear : LHCbGeneric\n")
+            fout.write("\tsmear : LHCbGenericIP\n")
+            if nAlt < altmass:
+                fout.write("\taltMass : %s\n" % ALTMASS[part.name])
+                nAlt += 1
+
+    if altmass > len(stable):
+        print("WARNING in stressDecay.py : only %d tracks available for alternative mass hypotheses" % len(stable))
+
+    return len(parts), len(stable)
+
+
+def findExe(exe):
+    if exe:
+        return exe
+    for path in os.environ.get("PATH", "").split(os.pathsep):
+        candidate = os.path.join(path, "RapidSim.exe")
+        if os.path.isfile(candidate):
+            return candidate
+    return os.path.join(os.environ["RAPIDSIM_ROOT"], "build", "src", "RapidSim.exe")
+
+
+def scan(args):
+    values = [int(v) for v in args.values.split(",")]
+    output = os.path.abspath(args.output)
+    modeDir = os.path.join(output, "modes")
+    if not os.path.isdir(modeDir):
+        os.makedirs(modeDir)
+
+    settings = dict((s, getattr(args, s)) for s in SETTINGS)
+    modes = []
+    sizes = {}
+    for value in values:
+        settings[args.vary] = value
+        mode = "stress_%s%d" % (args.vary, value)
+        try:
+            sizes[mode] = writeDecay(os.path.join(modeDir, mode), settings["depth"], settings["multiplicity"],
+                                     settings["resonances"], settings["altmass"], settings["pileup"], args.pid)
+        except ValueError as err:
+            print("WARNING in stressDecay.py : skipping %s = %d : %s" % (args.vary, value, err))
+            continue
+        modes.append(mode)
+
+    if not modes:
+        print("ERROR in stressDecay.py : no valid decays to run")
+        return 1
+
+    bench = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "validation", "runBenchmark.sh")
+    cmd = [bench, "-n", str(args.events), "-o", output, "-r", os.environ["RAPIDSIM_ROOT"], findExe(args.exe), modeDir] + modes
+    status = subprocess.call(cmd)
+
+    results = os.path.join(output, "rapidsim_bench.txt")
+    if not os.path.isfile(results):
+        print("ERROR in stressDecay.py : benchmark results not found")
+        return 1
+
+    with open(os.path.join(output, "scaling.csv"), "w") as fout:
+        fout.write("%s,particles,tracks,tree,init_s,events_per_s,selected_per_s,rss_mb\n" % args.vary)
+        for line in open(results).readlines()[1:]:
+            cols = line.split()
+            if len(cols) < 9 or cols[0] not in sizes or cols[3] == "-":
+                continue
+            value = cols[0][len("stress_" + args.vary):]
+            nParts, nTracks = sizes[cols[0]]
+            fout.write("%s,%d,%d,%s,%s,%s,%s,%s\n" % (value, nParts, nTracks, cols[1], cols[4], cols[6], cols[7], cols[8]))
+
+    print("INFO in stressDecay.py : scaling results written to %s" % os.path.join(output, "scaling.csv"))
+    return status
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate synthetic decays and measure how RapidSim scales with them.")
+    parser.add_argument("command", choices=["generate", "scan"])
+    parser.add_argument("name", nargs="?", help="decay mode to write (generate only)")
+    parser.add_argument("--depth", type=int, default=1, help="number of levels in the decay chain (1-%d)" % len(LADDER))
+    parser.add_argument("--multiplicity", type=int, default=3, help="number of daughters of each decay vertex")
+    parser.add_argument("--resonances", type=int, default=0, help="number of broad resonances added to the parent decay")
+    parser.add_argument("--altmass", type=int, default=0, help="number of tracks given an alternative mass hypothesis")
+    parser.add_argument("--pileup", type=int, default=1, help="mean number of pileup vertices")
+    parser.add_argument("--pid", action="store_true", help="add PID variables for each track")
+    parser.add_argument("--vary", choices=SETTINGS, help="setting to scan (scan only)")
+    parser.add_argument("--values", help="comma-separated values of the setting to scan (scan only)")
+    parser.add_argument("--events", type=int, default=10000, help="number of parents for each point of the scan")
+    parser.add_argument("--output", default="stress", help="output directory of the scan")
+    parser.add_argument("--exe", help="RapidSim.exe to run (default from PATH or RAPIDSIM_ROOT)")
+    args = parser.parse_args()
+
+    if args.command == "generate":
+        if not args.name:
+            parser.error("generate requires the name of the decay mode")
+        try:
+            nParts, nTracks = writeDecay(args.name, args.depth, args.multiplicity, args.resonances,
+                                         args.altmass, args.pileup, args.pid)
+        except ValueError as err:
+            print("ERROR in stressDecay.py : %s" % err)
+            return 1
+        print("INFO in stressDecay.py : written %s.decay and %s.config with %d particles (%d tracks)"
+              % (args.name, args.name, nParts, nTracks))
+        return 0
+
+    if not args.vary or not args.values:
+        parser.error("scan requires --vary and --values")
+    if "RAPIDSIM_ROOT" not in os.environ:
+        print("ERROR in stressDecay.py : environment variable RAPIDSIM_ROOT is not set")
+        return 1
+    return scan(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
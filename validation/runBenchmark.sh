@@ -0,0 +1,118 @@
+#!/bin/bash
+
+# Measure the throughput of each validation mode and check its histograms against the references.
+# Usage: runBenchmark.sh [-n events] [-o output directory] [-r RAPIDSIM_ROOT] <RapidSim.exe> <validation directory> <mode> [mode...]
+#
+# Each mode is generated once without and once with the tree. The initialisation time, generation
+# rate and selected rate are read from the run summary and tabulated, and the histograms from the
+# run without the tree are compared to the references with compareHistograms.C. The resident size of
+# the process at the end of each run is also given.
+# By default RAPIDSIM_ROOT is taken to be the parent of the validation directory.
+# The script exits with a non-zero status if any run fails or any comparison does not match.
+
+NEVT=""
+WORKDIR=bench
+ROOTDIR=""
+
+while getopts "n:o:r:" OPT; do
+	case ${OPT} in
+		n) NEVT=${OPTARG} ;;
+		o) WORKDIR=${OPTARG} ;;
+		r) ROOTDIR=$(readlink -f ${OPTARG}) ;;
+		*) exit 1 ;;
+	esac
+done
+shift $((OPTIND-1))
+
+if [ $# -lt 3 ]; then
+	echo "Usage: $0 [-n events] [-o output directory] [-r RAPIDSIM_ROOT] <RapidSim.exe> <validation directory> <mode> [mode...]"
+	exit 1
+fi
+
+EXE=$(readlink -f $1)
+VALIDATION=$(readlink -f $2)
+shift 2
+
+# use the data files and references that belong with the validation directory unless told otherwise
+if [ -n "${ROOTDIR}" ]; then
+	export RAPIDSIM_ROOT=${ROOTDIR}
+else
+	export RAPIDSIM_ROOT=$(dirname ${VALIDATION})
+fi
+
+# default numbers of parents, as in runValidation.sh
+nEvents() {
+	if [ -n "${NEVT}" ]; then
+		echo ${NEVT}
+		return
+	fi
+	case $1 in
+		Bs2D0Kpi) echo 10000 ;;
+		*) echo 100000 ;;
+	esac
+}
+
+# read a number from the run summary - keys are unique within the summary apart from the profile
+summaryValue() {
+	grep -m1 "\"$2\": " $1 | sed 's/.*: //;s/,$//'
+}
+
+mkdir -p ${WORKDIR}/plots
+cd ${WORKDIR}
+
+RESULTS=rapidsim_bench.txt
+FAILED=0
+
+printf "%-24s %5s %10s %10s %10s %10s %14s %14s %10s %8s\n" "mode" "tree" "parents" "selected" "init/s" "gen/s" "events/s" "selected/s" "RSS/MB" "physics" | tee ${RESULTS}
+
+for MODE in "$@"; do
+	N=$(nEvents ${MODE})
+	if [ ! -f ${VALIDATION}/${MODE}.decay ] || [ ! -f ${VALIDATION}/${MODE}.config ]; then
+		echo "ERROR in runBenchmark.sh : ${MODE}.decay and ${MODE}.config must both exist in ${VALIDATION}"
+		FAILED=1
+		continue
+	fi
+	cp ${VALIDATION}/${MODE}.decay ${VALIDATION}/${MODE}.config .
+
+	for TREE in 0 1; do
+		rm -f ${MODE}_tree*.root ${MODE}_tree_index.txt ${MODE}_summary.json
+
+		LOG=${MODE}_tree${TREE}.log
+		if ! ${EXE} ${MODE} ${N} ${TREE} > ${LOG} 2>&1 || [ ! -f ${MODE}_summary.json ]; then
+			printf "%-24s %5s %10s %10s %10s %10s %14s %14s %10s %8s\n" ${MODE} ${TREE} ${N} "-" "-" "-" "-" "-" "-" "FAILED" | tee -a ${RESULTS}
+			FAILED=1
+			continue
+		fi
+		cp ${MODE}_summary.json ${MODE}_tree${TREE}_summary.json
+
+		GENERATED=$(summaryValue ${MODE}_summary.json generated)
+		SELECTED=$(summaryValue ${MODE}_summary.json selected)
+		TINIT=$(summaryValue ${MODE}_summary.json initialiseWall)
+		TGEN=$(summaryValue ${MODE}_summary.json generateWall)
+		# the last memory snapshot is taken at the end of the run
+		RSS=$(grep "\"resident\": " ${MODE}_summary.json | tail -1 | sed 's/.*: //;s/,$//')
+
+		# physics is only checked once as the tree does not change the histograms
+		PHYSICS="-"
+		if [ ${TREE} -eq 0 ]; then
+			if [ ! -f ${VALIDATION}/rootfiles/${MODE}_hists.root ]; then
+				PHYSICS="no ref."
+			elif root -b -q -l "${VALIDATION}/compareHistograms.C(\"${MODE}\")" > ${MODE}_compare.log 2>&1 \
+				&& ! grep -q "ERROR in compareHistograms\|sum of p-values is unusually low" ${MODE}_compare.log; then
+				PHYSICS="ok"
+			else
+				PHYSICS="FAILED"
+				FAILED=1
+			fi
+		fi
+
+		awk -v mode=${MODE} -v tree=${TREE} -v n=${N} -v gen=${GENERATED} -v sel=${SELECTED} -v tinit=${TINIT} -v tgen=${TGEN} -v rss=${RSS:-0} -v phys="${PHYSICS}" \
+			'BEGIN { printf "%-24s %5s %10d %10d %10.2f %10.2f %14.1f %14.1f %10.1f %8s\n", mode, tree, n, sel, tinit, tgen, (tgen>0 ? gen/tgen : 0), (tgen>0 ? sel/tgen : 0), rss/1e6, phys }' | tee -a ${RESULTS}
+	done
+
+	rm -f ${MODE}_tree*.root ${MODE}_tree_index.txt
+done
+
+echo "Results written to $(pwd)/${RESULTS}"
+
+exit ${FAILED}